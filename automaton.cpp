@@ -0,0 +1,493 @@
+#include "automaton.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+
+const std::u16string Lambda = u"λ";
+const std::u16string Epsilon = u"ε";
+const char Magic[8] = {'P', 'D', 'A', 'I', 'M', 'A', 'G', 'E'};
+const uint32_t ByteOrderMark = 0x01020304;
+
+int32_t intern(std::unordered_map<std::u16string, int32_t>& ids,
+               std::vector<std::u16string>& names,
+               const std::u16string& name)
+{
+    auto it = ids.find(name);
+    if (it != ids.end()) {
+        return it->second;
+    }
+    const int32_t id = int32_t(names.size());
+    ids.emplace(name, id);
+    names.push_back(name);
+    return id;
+}
+
+int32_t find(const std::unordered_map<std::u16string, int32_t>& ids, const std::u16string& name)
+{
+    auto it = ids.find(name);
+    return it == ids.end() ? -1 : it->second;
+}
+
+size_t align(size_t offset)
+{
+    return (offset + 7) & ~size_t(7);
+}
+
+class ImageWriter
+{
+public:
+    explicit ImageWriter(size_t headerSize)
+        : bytes(std::make_shared<std::vector<char>>(align(headerSize), 0))
+    {
+    }
+
+    template<typename T>
+    uint64_t append(const T* data, size_t count)
+    {
+        const size_t offset = align(bytes->size());
+        bytes->resize(offset + count * sizeof(T));
+        if (count > 0) {
+            std::memcpy(bytes->data() + offset, data, count * sizeof(T));
+        }
+        return offset;
+    }
+
+    uint64_t append(const std::vector<std::u16string>& names)
+    {
+        std::vector<uint32_t> offsets{0};
+        std::u16string text;
+        for (const auto& name : names) {
+            text += name;
+            offsets.push_back(uint32_t(text.size()));
+        }
+        const uint64_t offset = append(offsets.data(), offsets.size());
+        append(text.data(), text.size());
+        return offset;
+    }
+
+    std::shared_ptr<std::vector<char>> bytes;
+};
+
+// Произведение a * b; false, если оно не помещается в 64 бита.
+bool multiply(uint64_t a, uint64_t b, uint64_t& result)
+{
+    if (a != 0 && b > UINT64_MAX / a) {
+        return false;
+    }
+    result = a * b;
+    return true;
+}
+
+// Сводки λ-переходов для всех пар (состояние, вершина). Чтобы снять вершину X правилом
+// без снятия, надо по очереди снять положенные символы, а затем саму X; с правилом,
+// заменяющим вершину на Y, — снять Y. Обход в глубину ведётся без рекурсии; пара,
+// встреченная снова, пока её сводка вычисляется, означает бесконечный цикл.
+std::vector<Automaton::LambdaSummary> summarizeLambda(const std::vector<int32_t>& table,
+                                                      const std::vector<Automaton::Rule>& rules,
+                                                      const std::vector<int32_t>& pushes,
+                                                      int32_t knownStates,
+                                                      int32_t knownSymbols,
+                                                      int32_t knownStackSymbols,
+                                                      int32_t lambda,
+                                                      int32_t& divergent)
+{
+    using Summary = Automaton::LambdaSummary;
+    const size_t pairs = size_t(knownStates) * knownStackSymbols;
+    std::vector<Summary> summaries(pairs, Summary{Automaton::NoTransition, Summary::Halts, 0});
+    divergent = 0;
+    if (lambda < 0 || lambda >= knownSymbols) {
+        return summaries;
+    }
+
+    enum Mark : uint8_t { Unvisited, InProgress, Done };
+    std::vector<uint8_t> marks(pairs, Unvisited);
+
+    struct Frame
+    {
+        size_t pair;
+        int32_t rule;
+        uint32_t index;
+        uint32_t total;
+        int32_t state;
+        uint64_t steps;
+    };
+    std::vector<Frame> frames;
+
+    auto open = [&](size_t pair) {
+        const int32_t rule = table[pair * knownSymbols + lambda];
+        if (rule == Automaton::NoTransition) {
+            marks[pair] = Done;
+            return;
+        }
+        const Automaton::Rule& r = rules[rule];
+        marks[pair] = InProgress;
+        frames.push_back({pair, rule, 0, r.pop ? r.pushCount : r.pushCount + 1, r.next, 1});
+    };
+    auto finish = [&](uint32_t kind, int32_t next, uint64_t steps) {
+        const Frame& f = frames.back();
+        summaries[f.pair] = Summary{next, kind, steps};
+        marks[f.pair] = Done;
+        if (kind == Summary::Diverges) {
+            ++divergent;
+        }
+        frames.pop_back();
+    };
+
+    for (size_t root = 0; root < pairs; ++root) {
+        if (marks[root] != Unvisited) {
+            continue;
+        }
+        open(root);
+        while (!frames.empty()) {
+            Frame& f = frames.back();
+            if (f.index == f.total) {
+                finish(Summary::Pops, f.state, f.steps);
+                continue;
+            }
+            const Automaton::Rule& r = rules[f.rule];
+            int32_t symbol = int32_t(f.pair % knownStackSymbols);
+            if (r.pop) {
+                symbol = pushes[r.pushOffset];
+            }
+            else if (f.index < r.pushCount) {
+                symbol = pushes[r.pushOffset + r.pushCount - 1 - f.index];
+            }
+            if (f.state < 0 || f.state >= knownStates || symbol < 0 || symbol >= knownStackSymbols) {
+                finish(Summary::Halts, Automaton::NoTransition, 0);
+                continue;
+            }
+
+            const size_t pair = size_t(f.state) * knownStackSymbols + symbol;
+            if (marks[pair] == InProgress) {
+                finish(Summary::Diverges, Automaton::NoTransition, 0);
+            }
+            else if (marks[pair] == Unvisited) {
+                open(pair);
+            }
+            else if (summaries[pair].kind != Summary::Pops) {
+                finish(summaries[pair].kind, Automaton::NoTransition, 0);
+            }
+            else {
+                f.state = summaries[pair].next;
+                f.steps = f.steps > UINT64_MAX - summaries[pair].steps ? UINT64_MAX : f.steps + summaries[pair].steps;
+                ++f.index;
+            }
+        }
+    }
+    return summaries;
+}
+
+}
+
+Automaton Automaton::compile(const AutomatonSpec& spec, uint64_t sourceChecksum)
+{
+    std::vector<std::u16string> stateNames;
+    std::vector<std::u16string> symbolNames;
+    std::vector<std::u16string> stackNames;
+    std::vector<std::u16string> pushTexts;
+    std::vector<int32_t> asciiSymbols(AsciiSymbols, UnknownSymbol);
+    std::vector<OtherSymbol> otherSymbols;
+
+    std::unordered_map<std::u16string, int32_t> stateIds;
+    for (const auto& name : spec.states) {
+        intern(stateIds, stateNames, name);
+    }
+    const int32_t knownStates = int32_t(stateNames.size());
+
+    std::unordered_map<std::u16string, int32_t> symbolIds;
+    for (const auto& name : spec.alphabet) {
+        const int32_t id = intern(symbolIds, symbolNames, name);
+        if (name.size() != 1) {
+            continue;
+        }
+        const char16_t c = name.front();
+        if (c < AsciiSymbols) {
+            if (asciiSymbols[c] == UnknownSymbol) {
+                asciiSymbols[c] = id;
+            }
+        }
+        else {
+            otherSymbols.push_back({c, id});
+        }
+    }
+    const int32_t knownSymbols = int32_t(symbolNames.size());
+    std::stable_sort(otherSymbols.begin(), otherSymbols.end(),
+                     [](const OtherSymbol& a, const OtherSymbol& b) { return a.c < b.c; });
+    otherSymbols.erase(std::unique(otherSymbols.begin(), otherSymbols.end(),
+                                   [](const OtherSymbol& a, const OtherSymbol& b) { return a.c == b.c; }),
+                       otherSymbols.end());
+
+    std::unordered_map<std::u16string, int32_t> stackIds;
+    for (const auto& name : spec.inStack) {
+        intern(stackIds, stackNames, name);
+    }
+    const int32_t knownStackSymbols = int32_t(stackNames.size());
+
+    std::vector<int32_t> table(size_t(knownStates) * knownStackSymbols * knownSymbols, NoTransition);
+    std::vector<Rule> rules;
+    std::vector<RuleKey> ruleKeys;
+    std::vector<int32_t> alternatives;
+    std::vector<int32_t> pushes;
+    int32_t sharedKeys = 0;
+    rules.reserve(spec.rules.size());
+    alternatives.reserve(spec.rules.size());
+    ruleKeys.reserve(spec.rules.size());
+    pushTexts.reserve(spec.rules.size());
+
+    for (const auto& r : spec.rules) {
+        Rule rule{};
+        rule.next = intern(stateIds, stateNames, r.next);
+        rule.pushOffset = uint32_t(pushes.size());
+
+        if (r.push.size() > 1) {
+            // Как в исходной симуляции: совпадающий с вершиной последний символ остаётся на месте,
+            // остальные кладутся поверх так, чтобы первый символ оказался на вершине.
+            size_t length = r.push.size();
+            if (r.push.substr(length - 1) == r.top) {
+                --length;
+            }
+            rule.pop = 0;
+            for (size_t i = length; i-- > 0;) {
+                pushes.push_back(intern(stackIds, stackNames, r.push.substr(i, 1)));
+            }
+        }
+        else if (r.push == Epsilon) {
+            rule.pop = 1;
+        }
+        else {
+            rule.pop = 1;
+            pushes.push_back(intern(stackIds, stackNames, r.push));
+        }
+        rule.pushCount = uint32_t(pushes.size()) - rule.pushOffset;
+
+        const RuleKey key{intern(stateIds, stateNames, r.state),
+                          intern(symbolIds, symbolNames, r.symbol),
+                          intern(stackIds, stackNames, r.top)};
+        const int32_t index = int32_t(rules.size());
+        rules.push_back(rule);
+        ruleKeys.push_back(key);
+        pushTexts.push_back(r.push);
+        alternatives.push_back(NoTransition);
+
+        if (key.state < knownStates && key.symbol < knownSymbols && key.top < knownStackSymbols) {
+            int32_t& slot = table[(size_t(key.state) * knownStackSymbols + key.top) * knownSymbols + key.symbol];
+            if (slot != NoTransition && alternatives[slot] == NoTransition) {
+                ++sharedKeys;
+            }
+            alternatives[index] = slot;
+            slot = index;
+        }
+    }
+
+    const int32_t start = intern(stateIds, stateNames, spec.start);
+    const int32_t startStack = intern(stackIds, stackNames, spec.startStack);
+
+    std::vector<uint8_t> finalStates(stateNames.size(), 0);
+    for (const auto& name : spec.ends) {
+        const int32_t state = find(stateIds, name);
+        if (state >= 0) {
+            finalStates[state] = 1;
+        }
+    }
+
+    int32_t divergentPairs = 0;
+    const std::vector<LambdaSummary> lambdaSummaries = summarizeLambda(
+        table, rules, pushes, knownStates, knownSymbols, knownStackSymbols, find(symbolIds, Lambda), divergentPairs);
+
+    Header header{};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.byteOrder = ByteOrderMark;
+    header.version = ImageVersion;
+    header.sourceChecksum = sourceChecksum;
+    header.stateCount = int32_t(stateNames.size());
+    header.knownStates = knownStates;
+    header.symbolCount = int32_t(symbolNames.size());
+    header.knownSymbols = knownSymbols;
+    header.stackCount = int32_t(stackNames.size());
+    header.knownStackSymbols = knownStackSymbols;
+    header.ruleCount = int32_t(rules.size());
+    header.sharedKeys = sharedKeys;
+    header.divergentPairs = divergentPairs;
+    header.pushCount = uint32_t(pushes.size());
+    header.otherSymbolCount = uint32_t(otherSymbols.size());
+    header.start = start;
+    header.startStack = startStack;
+    header.lambda = find(symbolIds, Lambda);
+    if (header.lambda >= knownSymbols) {
+        header.lambda = UnknownSymbol;
+    }
+
+    ImageWriter writer(sizeof(Header));
+    header.sections[TableSection] = writer.append(table.data(), table.size());
+    header.sections[RulesSection] = writer.append(rules.data(), rules.size());
+    header.sections[RuleKeysSection] = writer.append(ruleKeys.data(), ruleKeys.size());
+    header.sections[AlternativesSection] = writer.append(alternatives.data(), alternatives.size());
+    header.sections[PushesSection] = writer.append(pushes.data(), pushes.size());
+    header.sections[FinalStatesSection] = writer.append(finalStates.data(), finalStates.size());
+    header.sections[AsciiSymbolsSection] = writer.append(asciiSymbols.data(), asciiSymbols.size());
+    header.sections[OtherSymbolsSection] = writer.append(otherSymbols.data(), otherSymbols.size());
+    header.sections[StateNamesSection] = writer.append(stateNames);
+    header.sections[SymbolNamesSection] = writer.append(symbolNames);
+    header.sections[StackNamesSection] = writer.append(stackNames);
+    header.sections[PushTextsSection] = writer.append(pushTexts);
+    header.sections[LambdaSection] = writer.append(lambdaSummaries.data(), lambdaSummaries.size());
+    writer.bytes->resize(align(writer.bytes->size()));
+    header.size = writer.bytes->size();
+    std::memcpy(writer.bytes->data(), &header, sizeof(Header));
+
+    const char* data = writer.bytes->data();
+    const size_t size = writer.bytes->size();
+    return fromImage(std::move(writer.bytes), data, size);
+}
+
+Automaton Automaton::fromImage(std::shared_ptr<const void> owner, const char* data, size_t size)
+{
+    Automaton a;
+    if (size < sizeof(Header) || reinterpret_cast<uintptr_t>(data) % alignof(Header) != 0) {
+        return a;
+    }
+    const Header* h = reinterpret_cast<const Header*>(data);
+    if (std::memcmp(h->magic, Magic, sizeof(Magic)) != 0 || h->byteOrder != ByteOrderMark
+        || h->version != ImageVersion || h->size != size) {
+        return a;
+    }
+    if (h->knownStates < 0 || h->knownStates > h->stateCount
+        || h->knownSymbols < 0 || h->knownSymbols > h->symbolCount
+        || h->knownStackSymbols < 0 || h->knownStackSymbols > h->stackCount
+        || h->ruleCount < 0 || h->sharedKeys < 0 || h->divergentPairs < 0
+        || h->start < 0 || h->start >= h->stateCount
+        || h->startStack < 0 || h->startStack >= h->stackCount
+        || h->lambda < UnknownSymbol || h->lambda >= h->knownSymbols) {
+        return a;
+    }
+
+    auto section = [&](Section s, uint64_t count, uint64_t itemSize) -> const char* {
+        uint64_t bytes = 0;
+        const uint64_t offset = h->sections[s];
+        if (!multiply(count, itemSize, bytes) || offset % 8 != 0 || offset > size || bytes > size - offset) {
+            return nullptr;
+        }
+        return data + offset;
+    };
+    auto names = [&](Section s, int32_t count, Names& out) {
+        const char* offsets = section(s, uint64_t(count) + 1, sizeof(uint32_t));
+        if (!offsets) {
+            return false;
+        }
+        out.offsets = reinterpret_cast<const uint32_t*>(offsets);
+        for (int32_t i = 0; i < count; ++i) {
+            if (out.offsets[i] > out.offsets[i + 1]) {
+                return false;
+            }
+        }
+        const uint64_t textOffset = align(uint64_t(offsets - data) + (uint64_t(count) + 1) * sizeof(uint32_t));
+        const uint64_t textBytes = uint64_t(out.offsets[count]) * sizeof(char16_t);
+        if (out.offsets[0] != 0 || textOffset > size || textBytes > size - textOffset) {
+            return false;
+        }
+        out.text = reinterpret_cast<const char16_t*>(data + textOffset);
+        return true;
+    };
+
+    uint64_t tableSize = 0;
+    if (!multiply(uint64_t(h->knownStates) * uint64_t(h->knownStackSymbols), uint64_t(h->knownSymbols), tableSize)) {
+        return a;
+    }
+    const char* table = section(TableSection, tableSize, sizeof(int32_t));
+    const char* rules = section(RulesSection, uint64_t(h->ruleCount), sizeof(Rule));
+    const char* ruleKeys = section(RuleKeysSection, uint64_t(h->ruleCount), sizeof(RuleKey));
+    const char* alternatives = section(AlternativesSection, uint64_t(h->ruleCount), sizeof(int32_t));
+    const char* pushes = section(PushesSection, h->pushCount, sizeof(int32_t));
+    const char* lambdaSummaries = section(LambdaSection, uint64_t(h->knownStates) * uint64_t(h->knownStackSymbols),
+                                          sizeof(LambdaSummary));
+    const char* finalStates = section(FinalStatesSection, uint64_t(h->stateCount), sizeof(uint8_t));
+    const char* asciiSymbols = section(AsciiSymbolsSection, AsciiSymbols, sizeof(int32_t));
+    const char* otherSymbols = section(OtherSymbolsSection, h->otherSymbolCount, sizeof(OtherSymbol));
+    if (!table || !rules || !ruleKeys || !alternatives || !pushes || !lambdaSummaries || !finalStates || !asciiSymbols || !otherSymbols) {
+        return a;
+    }
+
+    a.table = reinterpret_cast<const int32_t*>(table);
+    a.rules = reinterpret_cast<const Rule*>(rules);
+    a.ruleKeys = reinterpret_cast<const RuleKey*>(ruleKeys);
+    a.alternatives = reinterpret_cast<const int32_t*>(alternatives);
+    a.pushes = reinterpret_cast<const int32_t*>(pushes);
+    a.lambdaSummaries = reinterpret_cast<const LambdaSummary*>(lambdaSummaries);
+    a.finalStates = reinterpret_cast<const uint8_t*>(finalStates);
+    a.asciiSymbols = reinterpret_cast<const int32_t*>(asciiSymbols);
+    a.otherSymbols = reinterpret_cast<const OtherSymbol*>(otherSymbols);
+    if (!names(StateNamesSection, h->stateCount, a.stateNames)
+        || !names(SymbolNamesSection, h->symbolCount, a.symbolNames)
+        || !names(StackNamesSection, h->stackCount, a.stackNames)
+        || !names(PushTextsSection, h->ruleCount, a.pushTexts)) {
+        return Automaton();
+    }
+
+    // Образ — кэш рядом с конфигурацией и может оказаться повреждённым, поэтому все ссылки,
+    // включая каждую клетку таблицы переходов, проверяются до первого обращения исполнителя.
+    for (uint64_t i = 0; i < tableSize; ++i) {
+        if (a.table[i] < NoTransition || a.table[i] >= h->ruleCount) {
+            return Automaton();
+        }
+    }
+    for (uint32_t c = 0; c < AsciiSymbols; ++c) {
+        if (a.asciiSymbols[c] < UnknownSymbol || a.asciiSymbols[c] >= h->symbolCount) {
+            return Automaton();
+        }
+    }
+    for (uint32_t i = 0; i < h->otherSymbolCount; ++i) {
+        if (a.otherSymbols[i].id < 0 || a.otherSymbols[i].id >= h->symbolCount) {
+            return Automaton();
+        }
+    }
+    for (int32_t i = 0; i < h->ruleCount; ++i) {
+        const Rule& rule = a.rules[i];
+        const RuleKey& key = a.ruleKeys[i];
+        if (rule.next < 0 || rule.next >= h->stateCount
+            || rule.pushOffset > h->pushCount || rule.pushCount > h->pushCount - rule.pushOffset
+            || key.state < 0 || key.state >= h->stateCount
+            || key.symbol < 0 || key.symbol >= h->symbolCount
+            || key.top < 0 || key.top >= h->stackCount
+            || a.alternatives[i] < NoTransition || a.alternatives[i] >= i) {
+            return Automaton();
+        }
+    }
+    for (uint32_t i = 0; i < h->pushCount; ++i) {
+        if (a.pushes[i] < 0 || a.pushes[i] >= h->stackCount) {
+            return Automaton();
+        }
+    }
+    for (uint64_t i = 0; i < uint64_t(h->knownStates) * uint64_t(h->knownStackSymbols); ++i) {
+        const LambdaSummary& summary = a.lambdaSummaries[i];
+        if (summary.kind > LambdaSummary::Diverges
+            || (summary.kind == LambdaSummary::Pops && (summary.next < 0 || summary.next >= h->stateCount))) {
+            return Automaton();
+        }
+    }
+
+    a.storage = std::move(owner);
+    a.header = h;
+    return a;
+}
+
+uint64_t Automaton::checksum(const char* data, size_t size)
+{
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= uint8_t(data[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+int32_t Automaton::otherSymbol(char16_t c) const
+{
+    const OtherSymbol* end = otherSymbols + header->otherSymbolCount;
+    const OtherSymbol* it = std::lower_bound(otherSymbols, end, c,
+                                             [](const OtherSymbol& s, char16_t value) { return s.c < value; });
+    return it != end && it->c == c ? it->id : UnknownSymbol;
+}
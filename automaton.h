@@ -0,0 +1,228 @@
+#ifndef AUTOMATON_H
+#define AUTOMATON_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct AutomatonSpec
+{
+    struct Rule
+    {
+        std::u16string state;
+        std::u16string symbol;
+        std::u16string top;
+        std::u16string next;
+        std::u16string push;
+    };
+
+    std::vector<std::u16string> states;
+    std::vector<std::u16string> alphabet;
+    std::vector<std::u16string> inStack;
+    std::vector<Rule> rules;
+    std::u16string start;
+    std::u16string startStack;
+    std::vector<std::u16string> ends;
+};
+
+// Автомат, скомпилированный в плотную таблицу переходов.
+// Состояния, входные символы и символы стека заменены целыми номерами;
+// номера, не входящие в исходные списки, считаются неизвестными.
+//
+// Все таблицы лежат в одном плоском образе (см. image()), который можно
+// сохранить в файл и затем отобразить в память через fromImage() без разбора.
+class Automaton
+{
+public:
+    struct Rule
+    {
+        int32_t next;
+        uint32_t pop;
+        uint32_t pushOffset;
+        uint32_t pushCount;
+    };
+
+    struct RuleKey
+    {
+        int32_t state;
+        int32_t symbol;
+        int32_t top;
+    };
+
+    // Итог цепочки λ-переходов из (состояние, вершина) после исчерпания входа:
+    // вершина снимается за steps шагов с переходом в next, вычисление застревает
+    // (нет правила или неизвестный символ) либо никогда не заканчивается.
+    struct LambdaSummary
+    {
+        enum Kind : uint32_t {
+            Pops,
+            Halts,
+            Diverges
+        };
+
+        int32_t next;
+        uint32_t kind;
+        uint64_t steps;
+    };
+
+    static constexpr int32_t NoTransition = -1;
+    static constexpr int32_t UnknownSymbol = -1;
+    static constexpr uint32_t ImageVersion = 3;
+
+    Automaton() = default;
+
+    static Automaton compile(const AutomatonSpec& spec, uint64_t sourceChecksum = 0);
+    // Возвращает пустой автомат, если образ повреждён или другой версии.
+    static Automaton fromImage(std::shared_ptr<const void> owner, const char* data, size_t size);
+    static uint64_t checksum(const char* data, size_t size);
+
+    bool isEmpty() const { return header == nullptr; }
+    const char* image() const { return reinterpret_cast<const char*>(header); }
+    size_t imageSize() const { return size_t(header->size); }
+    uint64_t sourceChecksum() const { return header->sourceChecksum; }
+
+    int32_t stateCount() const { return header->stateCount; }
+    int32_t symbolCount() const { return header->symbolCount; }
+    int32_t stackSymbolCount() const { return header->stackCount; }
+    int32_t ruleCount() const { return header->ruleCount; }
+    int32_t knownStateCount() const { return header->knownStates; }
+    int32_t knownSymbolCount() const { return header->knownSymbols; }
+    int32_t knownStackSymbolCount() const { return header->knownStackSymbols; }
+    // У каждого ключа (состояние, символ, вершина) не больше одного правила.
+    bool isDeterministic() const { return header->sharedKeys == 0; }
+
+    bool isKnownState(int32_t state) const { return uint32_t(state) < uint32_t(header->knownStates); }
+    bool isKnownSymbol(int32_t symbol) const { return uint32_t(symbol) < uint32_t(header->knownSymbols); }
+    bool isKnownStackSymbol(int32_t symbol) const { return uint32_t(symbol) < uint32_t(header->knownStackSymbols); }
+    bool isFinal(int32_t state) const { return uint32_t(state) < uint32_t(header->stateCount) && finalStates[state]; }
+
+    int32_t startState() const { return header->start; }
+    int32_t startStackSymbol() const { return header->startStack; }
+    int32_t lambda() const { return header->lambda; }
+
+    int32_t inputSymbol(char16_t c) const
+    {
+        if (c < AsciiSymbols) {
+            return asciiSymbols[c];
+        }
+        return otherSymbol(c);
+    }
+
+    int32_t transition(int32_t state, int32_t symbol, int32_t top) const
+    {
+        if (!isKnownState(state) || !isKnownSymbol(symbol) || !isKnownStackSymbol(top)) {
+            return NoTransition;
+        }
+        return table[(size_t(state) * header->knownStackSymbols + top) * header->knownSymbols + symbol];
+    }
+
+    // Плотная таблица, индексируемая как (state * knownStackSymbolCount() + top) * knownSymbolCount() + symbol.
+    const int32_t* transitionTable() const { return table; }
+
+    const LambdaSummary* lambdaSummary(int32_t state, int32_t top) const
+    {
+        if (!isKnownState(state) || !isKnownStackSymbol(top)) {
+            return nullptr;
+        }
+        return &lambdaSummaries[size_t(state) * header->knownStackSymbols + top];
+    }
+    // Число пар (состояние, вершина), из которых λ-переходы не завершаются.
+    int32_t divergentPairs() const { return header->divergentPairs; }
+
+    const Rule& rule(int32_t index) const { return rules[index]; }
+    // transition() возвращает последнее правило для ключа, как при перезаписи в ДМПА;
+    // более ранние правила с тем же ключом перечисляются цепочкой alternative().
+    int32_t alternative(int32_t index) const { return alternatives[index]; }
+    const RuleKey& ruleKey(int32_t index) const { return ruleKeys[index]; }
+    const int32_t* pushSequence(const Rule& r) const { return pushes + r.pushOffset; }
+
+    std::u16string_view stateName(int32_t state) const { return stateNames.at(state); }
+    std::u16string_view symbolName(int32_t symbol) const { return symbolNames.at(symbol); }
+    std::u16string_view stackSymbolName(int32_t symbol) const { return stackNames.at(symbol); }
+    // Правая часть правила в том виде, в каком она записана в конфигурации.
+    std::u16string_view pushText(int32_t index) const { return pushTexts.at(index); }
+
+private:
+    static constexpr char16_t AsciiSymbols = 128;
+
+    enum Section {
+        TableSection,
+        RulesSection,
+        RuleKeysSection,
+        AlternativesSection,
+        PushesSection,
+        FinalStatesSection,
+        AsciiSymbolsSection,
+        OtherSymbolsSection,
+        StateNamesSection,
+        SymbolNamesSection,
+        StackNamesSection,
+        PushTextsSection,
+        LambdaSection,
+        SectionCount
+    };
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t byteOrder;
+        uint32_t version;
+        uint64_t sourceChecksum;
+        uint64_t size;
+        int32_t stateCount;
+        int32_t knownStates;
+        int32_t symbolCount;
+        int32_t knownSymbols;
+        int32_t stackCount;
+        int32_t knownStackSymbols;
+        int32_t ruleCount;
+        int32_t sharedKeys;
+        int32_t divergentPairs;
+        uint32_t pushCount;
+        uint32_t otherSymbolCount;
+        int32_t start;
+        int32_t startStack;
+        int32_t lambda;
+        uint64_t sections[SectionCount];
+    };
+
+    struct OtherSymbol
+    {
+        uint32_t c;
+        int32_t id;
+    };
+
+    struct Names
+    {
+        const uint32_t* offsets = nullptr;
+        const char16_t* text = nullptr;
+
+        std::u16string_view at(int32_t index) const
+        {
+            return std::u16string_view(text + offsets[index], offsets[index + 1] - offsets[index]);
+        }
+    };
+
+    std::shared_ptr<const void> storage;
+    const Header* header = nullptr;
+    const int32_t* table = nullptr;
+    const Rule* rules = nullptr;
+    const RuleKey* ruleKeys = nullptr;
+    const int32_t* alternatives = nullptr;
+    const int32_t* pushes = nullptr;
+    const LambdaSummary* lambdaSummaries = nullptr;
+    const uint8_t* finalStates = nullptr;
+    const int32_t* asciiSymbols = nullptr;
+    const OtherSymbol* otherSymbols = nullptr;
+    Names stateNames;
+    Names symbolNames;
+    Names stackNames;
+    Names pushTexts;
+
+    int32_t otherSymbol(char16_t c) const;
+};
+
+#endif // AUTOMATON_H
@@ -0,0 +1,405 @@
+#include "configloader.h"
+#include "engine.h"
+#include "inputstream.h"
+#include "lockstepbatch.h"
+#include "nondeterministicsearch.h"
+#include "workstealingpool.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+
+namespace {
+
+const qsizetype ChunkLines = 4096;
+
+struct Chunk
+{
+    qsizetype first = 0;
+    qsizetype count = 0;
+    std::vector<Engine::Outcome> outcomes;
+    RunStatistics statistics;
+    bool done = false;
+};
+
+QString toQString(std::u16string_view text)
+{
+    return QString::fromUtf16(text.data(), text.size());
+}
+
+QString csvField(const QString& text)
+{
+    if (!text.contains(',') && !text.contains('"') && !text.contains('\n')) {
+        return text;
+    }
+    return '"' + QString(text).replace("\"", "\"\"") + '"';
+}
+
+QByteArray statisticsToJson(const Automaton& automaton, const RunStatistics& statistics)
+{
+    QJsonObject phases;
+    phases["loadSeconds"] = statistics.loadSeconds;
+    phases["compileSeconds"] = statistics.compileSeconds;
+    phases["runSeconds"] = statistics.runSeconds;
+
+    QJsonArray histogram;
+    for (int bucket = 0; bucket < RunStatistics::DepthBuckets; ++bucket) {
+        if (statistics.depthHistogram[bucket] == 0) {
+            continue;
+        }
+        QJsonObject entry;
+        entry["from"] = double(bucket == 0 ? 0 : uint64_t(1) << (bucket - 1));
+        entry["to"] = double(bucket == 0 ? 0 : (uint64_t(1) << (bucket - 1)) * 2 - 1);
+        entry["steps"] = double(statistics.depthHistogram[bucket]);
+        histogram.append(entry);
+    }
+
+    QJsonArray rules;
+    for (int32_t index = 0; index < automaton.ruleCount(); ++index) {
+        const Automaton::RuleKey& key = automaton.ruleKey(index);
+        QJsonObject rule;
+        rule["index"] = index;
+        rule["state"] = toQString(automaton.stateName(key.state));
+        rule["symbol"] = toQString(automaton.symbolName(key.symbol));
+        rule["top"] = toQString(automaton.stackSymbolName(key.top));
+        rule["next"] = toQString(automaton.stateName(automaton.rule(index).next));
+        rule["push"] = toQString(automaton.pushText(index));
+        rule["hits"] = double(statistics.ruleHits[index]);
+        rules.append(rule);
+    }
+
+    QJsonObject root;
+    root["chains"] = double(statistics.runs);
+    root["accepted"] = double(statistics.accepted);
+    root["inputSymbols"] = double(statistics.inputSymbols);
+    root["inputMoves"] = double(statistics.inputMoves);
+    root["lambdaMoves"] = double(statistics.lambdaMoves);
+    root["stepsPerSymbol"] = statistics.stepsPerSymbol();
+    root["maxDepth"] = double(statistics.maxDepth);
+    root["meanDepth"] = statistics.meanDepth();
+    root["depthHistogram"] = histogram;
+    root["phases"] = phases;
+    root["rules"] = rules;
+    return QJsonDocument(root).toJson();
+}
+
+// Две таблицы через пустую строку: сводка (metric,value) и правила с числом срабатываний.
+QByteArray statisticsToCsv(const Automaton& automaton, const RunStatistics& statistics)
+{
+    QString text = "metric,value\n";
+    auto metric = [&](const QString& name, const QString& value) { text += name + ',' + value + '\n'; };
+    metric("chains", QString::number(statistics.runs));
+    metric("accepted", QString::number(statistics.accepted));
+    metric("input_symbols", QString::number(statistics.inputSymbols));
+    metric("input_moves", QString::number(statistics.inputMoves));
+    metric("lambda_moves", QString::number(statistics.lambdaMoves));
+    metric("steps_per_symbol", QString::number(statistics.stepsPerSymbol()));
+    metric("max_depth", QString::number(statistics.maxDepth));
+    metric("mean_depth", QString::number(statistics.meanDepth()));
+    metric("load_seconds", QString::number(statistics.loadSeconds));
+    metric("compile_seconds", QString::number(statistics.compileSeconds));
+    metric("run_seconds", QString::number(statistics.runSeconds));
+    for (int bucket = 0; bucket < RunStatistics::DepthBuckets; ++bucket) {
+        if (statistics.depthHistogram[bucket] > 0) {
+            const uint64_t from = bucket == 0 ? 0 : uint64_t(1) << (bucket - 1);
+            const uint64_t to = bucket == 0 ? 0 : from * 2 - 1;
+            metric(QString("depth_%1-%2").arg(from).arg(to), QString::number(statistics.depthHistogram[bucket]));
+        }
+    }
+
+    text += "\nrule,state,symbol,top,next,push,hits\n";
+    for (int32_t index = 0; index < automaton.ruleCount(); ++index) {
+        const Automaton::RuleKey& key = automaton.ruleKey(index);
+        text += QString::number(index) + ','
+                + csvField(toQString(automaton.stateName(key.state))) + ','
+                + csvField(toQString(automaton.symbolName(key.symbol))) + ','
+                + csvField(toQString(automaton.stackSymbolName(key.top))) + ','
+                + csvField(toQString(automaton.stateName(automaton.rule(index).next))) + ','
+                + csvField(toQString(automaton.pushText(index))) + ','
+                + QString::number(statistics.ruleHits[index]) + '\n';
+    }
+    return text.toUtf8();
+}
+
+bool writeStatistics(const QString& filePath, const Automaton& automaton, const RunStatistics& statistics)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Не удалось открыть файл:" << filePath;
+        return false;
+    }
+    const QByteArray data = filePath.endsWith(".csv", Qt::CaseInsensitive) ? statisticsToCsv(automaton, statistics)
+                                                                           : statisticsToJson(automaton, statistics);
+    return file.write(data) == data.size();
+}
+
+std::vector<std::pair<qsizetype, qsizetype>> splitLines(const QByteArray& data)
+{
+    std::vector<std::pair<qsizetype, qsizetype>> lines;
+    qsizetype begin = 0;
+    while (begin < data.size()) {
+        qsizetype end = data.indexOf('\n', begin);
+        if (end < 0) {
+            end = data.size();
+        }
+        qsizetype length = end - begin;
+        if (length > 0 && data[end - 1] == '\r') {
+            --length;
+        }
+        lines.emplace_back(begin, length);
+        begin = end + 1;
+    }
+    return lines;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("machine-batch");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Проверяет принадлежность цепочек (по одной в строке) заданному ДМПА.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("config", "Файл конфигурации автомата (JSON) или его образ (*.pdaimg).");
+    parser.addPositionalArgument("inputs", "Файл с входными цепочками (в режиме --stream — одна цепочка, \"-\" — stdin).");
+    QCommandLineOption outputOption({"o", "output"}, "Файл для результатов (по умолчанию stdout).", "file");
+    QCommandLineOption threadsOption({"j", "threads"}, "Число потоков (по умолчанию все ядра).", "count", "0");
+    QCommandLineOption compileOption("compile", "Только собрать бинарный образ конфигурации и выйти.");
+    QCommandLineOption noImageOption("no-image", "Не использовать и не обновлять бинарный образ.");
+    QCommandLineOption npdaOption("npda", "Недетерминированный режим: все правила с одинаковым ключом рассматриваются как варианты.");
+    QCommandLineOption lockstepOption("lockstep", "Продвигать цепочки блока одновременно (выгодно для коротких цепочек и больших таблиц).");
+    QCommandLineOption streamOption("stream", "Весь файл — одна цепочка; она читается потоком за один проход.");
+    QCommandLineOption statsOption("stats", "Записать статистику выполнения в файл: JSON или CSV (по расширению .csv).", "file");
+    QCommandLineOption limitOption("limit", "Предел числа конфигураций на цепочку в режиме --npda.", "count", "10000000");
+    parser.addOption(outputOption);
+    parser.addOption(threadsOption);
+    parser.addOption(compileOption);
+    parser.addOption(noImageOption);
+    parser.addOption(npdaOption);
+    parser.addOption(limitOption);
+    parser.addOption(streamOption);
+    parser.addOption(lockstepOption);
+    parser.addOption(statsOption);
+    parser.process(app);
+
+    const QStringList arguments = parser.positionalArguments();
+    const bool compileOnly = parser.isSet(compileOption);
+    if (arguments.size() != (compileOnly ? 1 : 2)) {
+        parser.showHelp(1);
+    }
+
+    Automaton automaton;
+    LoadTimings timings;
+    if (!loadAutomaton(arguments[0], automaton, compileOnly || !parser.isSet(noImageOption), &timings)) {
+        return 1;
+    }
+    if (compileOnly) {
+        return 0;
+    }
+    if (!automaton.isDeterministic() && !parser.isSet(npdaOption)) {
+        qWarning() << "Автомат недетерминирован: для каждого ключа используется последнее правило (см. --npda).";
+    }
+
+    const bool collect = parser.isSet(statsOption);
+    if (collect && (parser.isSet(npdaOption) || parser.isSet(streamOption))) {
+        qWarning() << "Статистика собирается только при проверке строк ДМПА; --stats игнорируется.";
+    }
+    if (collect && parser.isSet(lockstepOption)) {
+        qWarning() << "Для сбора статистики цепочки проверяются по одной; --lockstep игнорируется.";
+    }
+
+    if (parser.isSet(streamOption)) {
+        if (parser.isSet(npdaOption)) {
+            qWarning() << "Режим --stream поддерживает только ДМПА.";
+            return 1;
+        }
+        InputStream stream;
+        if (!stream.open(arguments[1])) {
+            return 1;
+        }
+        QElapsedTimer timer;
+        timer.start();
+        Engine engine(automaton);
+        const Engine::Outcome outcome = recognizeStream(engine, stream);
+        if (outcome == Engine::Outcome::Running) {
+            return 1;
+        }
+        const QByteArray verdict = outcome == Engine::Outcome::Accepted ? "accepted\n" : "rejected\n";
+        if (parser.isSet(outputOption)) {
+            QFile output(parser.value(outputOption));
+            if (!output.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                qWarning() << "Не удалось открыть файл:" << parser.value(outputOption);
+                return 1;
+            }
+            output.write(verdict);
+        }
+        else {
+            std::fwrite(verdict.constData(), 1, size_t(verdict.size()), stdout);
+        }
+        std::fprintf(stderr, "%lld байт прочитано, %llu шагов, %lld мс\n",
+                     static_cast<long long>(stream.bytesRead()), static_cast<unsigned long long>(engine.steps()),
+                     static_cast<long long>(timer.elapsed()));
+        return 0;
+    }
+
+    QFile inputFile(arguments[1]);
+    if (!inputFile.open(QIODevice::ReadOnly)) {
+        qWarning() << "Не удалось открыть файл:" << arguments[1];
+        return 1;
+    }
+    const QByteArray data = inputFile.readAll();
+    inputFile.close();
+
+    QFile output;
+    if (parser.isSet(outputOption)) {
+        output.setFileName(parser.value(outputOption));
+        if (!output.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qWarning() << "Не удалось открыть файл:" << parser.value(outputOption);
+            return 1;
+        }
+    }
+    else if (!output.open(stdout, QIODevice::WriteOnly)) {
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const auto lines = splitLines(data);
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    for (qsizetype first = 0; first < qsizetype(lines.size()); first += ChunkLines) {
+        auto chunk = std::make_unique<Chunk>();
+        chunk->first = first;
+        chunk->count = std::min(ChunkLines, qsizetype(lines.size()) - first);
+        chunks.push_back(std::move(chunk));
+    }
+
+    WorkStealingPool pool(parser.value(threadsOption).toUInt());
+
+    if (parser.isSet(npdaOption)) {
+        // Цепочки проверяются по очереди, а граф конфигураций каждой обходится всеми потоками.
+        NondeterministicSearch search(automaton, parser.value(limitOption).toULongLong());
+        qsizetype accepted = 0;
+        qsizetype undecided = 0;
+        for (const auto& [offset, length] : lines) {
+            const QString line = QString::fromUtf8(data.constData() + offset, length);
+            const std::u16string_view input(reinterpret_cast<const char16_t*>(line.utf16()), size_t(line.size()));
+            switch (search.run(input, &pool)) {
+            case NondeterministicSearch::Result::Accepted:
+                output.write("accepted\n");
+                ++accepted;
+                break;
+            case NondeterministicSearch::Result::Rejected:
+                output.write("rejected\n");
+                break;
+            case NondeterministicSearch::Result::LimitExceeded:
+                output.write("undecided\n");
+                ++undecided;
+                break;
+            }
+        }
+        output.close();
+
+        std::fprintf(stderr, "%lld строк, принято %lld, отвергнуто %lld, не решено %lld, %lld мс, потоков %u\n",
+                     static_cast<long long>(lines.size()), static_cast<long long>(accepted),
+                     static_cast<long long>(lines.size()) - accepted - undecided, static_cast<long long>(undecided),
+                     static_cast<long long>(timer.elapsed()), pool.size());
+        return 0;
+    }
+
+    std::mutex doneMutex;
+    std::condition_variable doneChanged;
+    const bool lockstep = parser.isSet(lockstepOption) && !collect;
+    // Таблица правил разворачивается один раз; задачи получают копии со своими дорожками.
+    std::unique_ptr<const LockstepBatch> lockstepPrototype = lockstep ? std::make_unique<LockstepBatch>(automaton) : nullptr;
+
+    for (auto& chunk : chunks) {
+        pool.submit([&, target = chunk.get()] {
+            if (lockstep) {
+                std::vector<QString> texts;
+                std::vector<std::u16string_view> inputs;
+                texts.reserve(target->count);
+                inputs.reserve(target->count);
+                for (qsizetype i = target->first; i < target->first + target->count; ++i) {
+                    texts.push_back(QString::fromUtf8(data.constData() + lines[i].first, lines[i].second));
+                    inputs.emplace_back(reinterpret_cast<const char16_t*>(texts.back().utf16()), size_t(texts.back().size()));
+                }
+                target->outcomes.resize(target->count);
+                LockstepBatch(*lockstepPrototype).run(inputs.data(), inputs.size(), target->outcomes.data());
+            }
+            else {
+                Engine engine(automaton);
+                if (collect) {
+                    target->statistics.reset(automaton.ruleCount());
+                    engine.setStatistics(&target->statistics);
+                }
+                target->outcomes.reserve(target->count);
+                for (qsizetype i = target->first; i < target->first + target->count; ++i) {
+                    const QString line = QString::fromUtf8(data.constData() + lines[i].first, lines[i].second);
+                    const std::u16string_view input(reinterpret_cast<const char16_t*>(line.utf16()), size_t(line.size()));
+                    target->outcomes.push_back(engine.run(input));
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(doneMutex);
+                target->done = true;
+            }
+            doneChanged.notify_all();
+        });
+    }
+
+    qsizetype accepted = 0;
+    RunStatistics statistics;
+    statistics.reset(automaton.ruleCount());
+    for (auto& chunk : chunks) {
+        {
+            std::unique_lock<std::mutex> lock(doneMutex);
+            doneChanged.wait(lock, [&] { return chunk->done; });
+        }
+        if (collect) {
+            statistics.merge(chunk->statistics);
+        }
+        QByteArray text;
+        text.reserve(chunk->count * 9);
+        for (Engine::Outcome outcome : chunk->outcomes) {
+            if (outcome == Engine::Outcome::Accepted) {
+                text += "accepted\n";
+                ++accepted;
+            }
+            else {
+                text += "rejected\n";
+            }
+        }
+        output.write(text);
+        chunk.reset();
+    }
+    pool.wait();
+    output.close();
+
+    if (collect) {
+        statistics.loadSeconds = timings.loadSeconds;
+        statistics.compileSeconds = timings.compileSeconds;
+        statistics.runSeconds = timer.nsecsElapsed() / 1e9;
+        if (!writeStatistics(parser.value(statsOption), automaton, statistics)) {
+            return 1;
+        }
+    }
+
+    std::fprintf(stderr, "%lld строк, принято %lld, отвергнуто %lld, %lld мс, потоков %u\n",
+                 static_cast<long long>(lines.size()), static_cast<long long>(accepted),
+                 static_cast<long long>(lines.size()) - accepted,
+                 static_cast<long long>(timer.elapsed()), pool.size());
+    return 0;
+}
@@ -0,0 +1,453 @@
+#include "configloader.h"
+#include "engine.h"
+#include "inputstream.h"
+#include "lockstepbatch.h"
+#include "nondeterministicsearch.h"
+#include "recognizercheck.h"
+#include "recognizergenerator.h"
+#include "runstatistics.h"
+#include "workloadgenerator.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+
+namespace {
+
+struct Measurement
+{
+    double seconds = 0;
+    uint64_t steps = 0;
+    uint64_t accepted = 0;
+};
+
+QString toQString(std::u16string_view text)
+{
+    return QString::fromUtf16(text.data(), text.size());
+}
+
+bool writeFile(const QString& filePath, const QByteArray& data)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Не удалось открыть файл:" << filePath;
+        return false;
+    }
+    return file.write(data) == data.size();
+}
+
+QJsonArray toJsonArray(const std::vector<std::u16string>& names)
+{
+    QJsonArray array;
+    for (const auto& name : names) {
+        array.append(toQString(name));
+    }
+    return array;
+}
+
+// Конфигурация в том же формате, что читает parseAutomatonSpec().
+QByteArray specToJson(const AutomatonSpec& spec)
+{
+    QJsonArray rules;
+    for (const auto& rule : spec.rules) {
+        rules.append(QJsonArray{toQString(rule.state), toQString(rule.symbol), toQString(rule.top),
+                                toQString(rule.next), toQString(rule.push)});
+    }
+    QJsonObject root;
+    root["states"] = toJsonArray(spec.states);
+    root["alphabet"] = toJsonArray(spec.alphabet);
+    root["in_stack"] = toJsonArray(spec.inStack);
+    root["rules"] = rules;
+    root["start"] = toQString(spec.start);
+    root["start_stack"] = toQString(spec.startStack);
+    root["ends"] = toJsonArray(spec.ends);
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+QByteArray corpusToText(const std::vector<std::u16string>& chains)
+{
+    QByteArray text;
+    for (const auto& chain : chains) {
+        text += toQString(chain).toUtf8();
+        text += '\n';
+    }
+    return text;
+}
+
+// Пиковый резидентный объём процесса. На Linux пик сбрасывается перед каждым режимом
+// (clear_refs), на других системах не измеряется.
+void resetPeakMemory()
+{
+#ifdef Q_OS_LINUX
+    QFile file("/proc/self/clear_refs");
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write("5");
+    }
+#endif
+}
+
+qint64 memoryKb(const QByteArray& field)
+{
+#ifdef Q_OS_LINUX
+    QFile file("/proc/self/status");
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return -1;
+    }
+    // readAll() у файлов /proc возвращает всё содержимое, хотя size() равен нулю.
+    for (const QByteArray& line : file.readAll().split('\n')) {
+        if (line.startsWith(field + ':')) {
+            return line.mid(field.size() + 1).trimmed().split(' ').value(0).toLongLong();
+        }
+    }
+#else
+    Q_UNUSED(field);
+#endif
+    return -1;
+}
+
+double median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    const size_t middle = values.size() / 2;
+    return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+}
+
+// Повторяет замер repeat раз; в отчёт идут лучшее и медианное время и пик памяти за все повторы.
+QJsonObject measure(const QString& mode, int repeat, uint64_t symbols, const std::function<Measurement()>& body)
+{
+    const qint64 baseline = memoryKb("VmRSS");
+    resetPeakMemory();
+    std::vector<double> times;
+    Measurement result;
+    for (int i = 0; i < repeat; ++i) {
+        result = body();
+        times.push_back(result.seconds);
+    }
+    const double best = *std::min_element(times.begin(), times.end());
+
+    QJsonObject entry;
+    entry["mode"] = mode;
+    entry["seconds"] = best;
+    entry["medianSeconds"] = median(times);
+    entry["symbols"] = double(symbols);
+    entry["steps"] = double(result.steps);
+    entry["accepted"] = double(result.accepted);
+    entry["stepsPerSecond"] = best > 0 ? double(result.steps) / best : 0.0;
+    entry["symbolsPerSecond"] = best > 0 ? double(symbols) / best : 0.0;
+    entry["baselineKb"] = double(baseline);
+    entry["peakKb"] = double(memoryKb("VmHWM"));
+
+    std::fprintf(stderr, "%-10s %10.3f мс (медиана %.3f), %.3g шагов/с, принято %llu\n",
+                 qPrintable(mode), best * 1e3, median(times) * 1e3, entry["stepsPerSecond"].toDouble(),
+                 static_cast<unsigned long long>(result.accepted));
+    return entry;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("machine-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Порождает ДМПА и набор цепочек по seed и замеряет загрузку и проверку в разных режимах. "
+                                     "Результат выводится в JSON.");
+    parser.addHelpOption();
+    QCommandLineOption kindOption("kind", "Вид автомата: random, palindrome (глубокий стек) или lambda (длинные λ-цепочки).", "kind", "random");
+    QCommandLineOption statesOption("states", "Число состояний (для lambda — длина λ-цепочки).", "n", "64");
+    QCommandLineOption symbolsOption("symbols", "Размер входного алфавита.", "n", "16");
+    QCommandLineOption stackSymbolsOption("stack-symbols", "Размер алфавита стека.", "n", "8");
+    QCommandLineOption rulesOption("rules", "Число правил (для random).", "n", "4096");
+    QCommandLineOption lambdaOption("lambda", "Доля λ-правил (для random).", "fraction", "0.1");
+    QCommandLineOption seedOption("seed", "Начальное значение генератора.", "n", "1");
+    QCommandLineOption chainsOption("chains", "Число цепочек в наборе.", "n", "10000");
+    QCommandLineOption lengthOption("length", "Наибольшая длина цепочки набора.", "n", "256");
+    QCommandLineOption streamLengthOption("stream-length", "Длина цепочки для режима stream.", "n", "4194304");
+    QCommandLineOption repeatOption("repeat", "Число повторов каждого замера.", "n", "5");
+    QCommandLineOption modesOption("modes", "Режимы через запятую: engine, lockstep, stream, npda, compiled.", "list",
+                                   "engine,lockstep,stream");
+    QCommandLineOption compilerOption("compiler", "Компилятор C++ для режима compiled (по умолчанию $CXX или c++).", "path");
+    QCommandLineOption outputOption({"o", "output"}, "Файл для JSON (по умолчанию stdout).", "file");
+    QCommandLineOption saveOption("save", "Сохранить автомат (config.json) и набор (chains.txt) в каталог.", "dir");
+    parser.addOption(kindOption);
+    parser.addOption(statesOption);
+    parser.addOption(symbolsOption);
+    parser.addOption(stackSymbolsOption);
+    parser.addOption(rulesOption);
+    parser.addOption(lambdaOption);
+    parser.addOption(seedOption);
+    parser.addOption(chainsOption);
+    parser.addOption(lengthOption);
+    parser.addOption(streamLengthOption);
+    parser.addOption(repeatOption);
+    parser.addOption(modesOption);
+    parser.addOption(compilerOption);
+    parser.addOption(outputOption);
+    parser.addOption(saveOption);
+    parser.process(app);
+
+    WorkloadOptions options;
+    const QString kind = parser.value(kindOption);
+    if (kind == "random") {
+        options.kind = WorkloadOptions::Kind::Random;
+    }
+    else if (kind == "palindrome") {
+        options.kind = WorkloadOptions::Kind::Palindrome;
+    }
+    else if (kind == "lambda") {
+        options.kind = WorkloadOptions::Kind::Lambda;
+    }
+    else {
+        qWarning() << "Неизвестный вид автомата:" << kind;
+        return 1;
+    }
+    options.states = parser.value(statesOption).toInt();
+    options.symbols = parser.value(symbolsOption).toInt();
+    options.stackSymbols = parser.value(stackSymbolsOption).toInt();
+    options.rules = parser.value(rulesOption).toInt();
+    options.lambdaDensity = parser.value(lambdaOption).toDouble();
+    options.seed = parser.value(seedOption).toULongLong();
+    const qsizetype chainCount = std::max<qsizetype>(parser.value(chainsOption).toLongLong(), 1);
+    const size_t length = size_t(std::max<qint64>(parser.value(lengthOption).toLongLong(), 0));
+    const size_t streamLength = size_t(std::max<qint64>(parser.value(streamLengthOption).toLongLong(), 0));
+    const int repeat = std::max(parser.value(repeatOption).toInt(), 1);
+    const QStringList modes = parser.value(modesOption).split(',', Qt::SkipEmptyParts);
+
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        qWarning() << "Не удалось создать временный каталог";
+        return 1;
+    }
+
+    // Генерация: автомат, набор коротких цепочек и одна длинная для потокового режима.
+    WorkloadGenerator generator(options);
+    std::vector<std::u16string> chains;
+    chains.reserve(size_t(chainCount));
+    uint64_t corpusSymbols = 0;
+    for (qsizetype i = 0; i < chainCount; ++i) {
+        chains.push_back(generator.chain(length));
+        corpusSymbols += chains.back().size();
+    }
+    const std::u16string longChain = modes.contains("stream") ? generator.chain(streamLength) : std::u16string();
+
+    const QString configPath = dir.filePath("config.json");
+    const QString corpusPath = dir.filePath("chains.txt");
+    const QString streamPath = dir.filePath("stream.txt");
+    const QByteArray config = specToJson(generator.spec());
+    const QByteArray corpus = corpusToText(chains);
+    if (!writeFile(configPath, config) || !writeFile(corpusPath, corpus)
+        || !writeFile(streamPath, toQString(longChain).toUtf8())) {
+        return 1;
+    }
+    if (parser.isSet(saveOption)) {
+        const QDir saveDir(parser.value(saveOption));
+        if (!QDir().mkpath(saveDir.path()) || !writeFile(saveDir.filePath("config.json"), config)
+            || !writeFile(saveDir.filePath("chains.txt"), corpus)) {
+            qWarning() << "Не удалось сохранить автомат и набор в" << saveDir.path();
+            return 1;
+        }
+    }
+
+    // Загрузка: разбор JSON с компиляцией таблицы и отображение готового образа.
+    Automaton automaton;
+    LoadTimings best;
+    double imageSeconds = 0;
+    for (int i = 0; i < repeat; ++i) {
+        LoadTimings timings;
+        if (!loadAutomaton(configPath, automaton, false, &timings)) {
+            return 1;
+        }
+        best.loadSeconds = i == 0 ? timings.loadSeconds : std::min(best.loadSeconds, timings.loadSeconds);
+        best.compileSeconds = i == 0 ? timings.compileSeconds : std::min(best.compileSeconds, timings.compileSeconds);
+    }
+    const QString imagePath = automatonImagePath(configPath);
+    if (!saveAutomatonImage(automaton, imagePath)) {
+        qWarning() << "Не удалось сохранить образ:" << imagePath;
+        return 1;
+    }
+    for (int i = 0; i < repeat; ++i) {
+        LoadTimings timings;
+        Automaton image;
+        if (!loadAutomaton(imagePath, image, true, &timings)) {
+            return 1;
+        }
+        imageSeconds = i == 0 ? timings.loadSeconds : std::min(imageSeconds, timings.loadSeconds);
+    }
+
+    // Профиль набора: отдельный прогон со счётчиками, чтобы они не влияли на замеры времени.
+    RunStatistics profile;
+    profile.reset(automaton.ruleCount());
+    {
+        Engine engine(automaton);
+        engine.setStatistics(&profile);
+        for (const auto& chain : chains) {
+            engine.run(chain);
+        }
+    }
+    const uint64_t unusedRules = uint64_t(std::count(profile.ruleHits.begin(), profile.ruleHits.end(), uint64_t(0)));
+
+    QJsonArray results;
+    for (const QString& mode : modes) {
+        if (mode == "engine") {
+            results.append(measure(mode, repeat, corpusSymbols, [&] {
+                Measurement m;
+                QElapsedTimer timer;
+                timer.start();
+                Engine engine(automaton);
+                for (const auto& chain : chains) {
+                    m.accepted += engine.run(chain) == Engine::Outcome::Accepted;
+                    m.steps += engine.steps();
+                }
+                m.seconds = timer.nsecsElapsed() / 1e9;
+                return m;
+            }));
+        }
+        else if (mode == "lockstep") {
+            std::vector<std::u16string_view> views(chains.begin(), chains.end());
+            std::vector<Engine::Outcome> outcomes(chains.size());
+            results.append(measure(mode, repeat, corpusSymbols, [&] {
+                Measurement m;
+                QElapsedTimer timer;
+                timer.start();
+                LockstepBatch batch(automaton);
+                batch.run(views.data(), views.size(), outcomes.data());
+                m.seconds = timer.nsecsElapsed() / 1e9;
+                // LockstepBatch не считает шаги; исходы совпадают с Engine, значит, и шаги те же.
+                m.steps = profile.steps();
+                m.accepted = uint64_t(std::count(outcomes.begin(), outcomes.end(), Engine::Outcome::Accepted));
+                return m;
+            }));
+        }
+        else if (mode == "stream") {
+            results.append(measure(mode, repeat, longChain.size(), [&] {
+                Measurement m;
+                QElapsedTimer timer;
+                timer.start();
+                InputStream stream;
+                Engine engine(automaton);
+                if (stream.open(streamPath)) {
+                    m.accepted = recognizeStream(engine, stream) == Engine::Outcome::Accepted;
+                }
+                m.seconds = timer.nsecsElapsed() / 1e9;
+                m.steps = engine.steps();
+                return m;
+            }));
+        }
+        else if (mode == "npda") {
+            // Вместо шагов считаются посещённые конфигурации поиска.
+            results.append(measure(mode, repeat, corpusSymbols, [&] {
+                Measurement m;
+                QElapsedTimer timer;
+                timer.start();
+                NondeterministicSearch search(automaton);
+                for (const auto& chain : chains) {
+                    m.accepted += search.run(chain) == NondeterministicSearch::Result::Accepted;
+                    m.steps += search.configurations();
+                }
+                m.seconds = timer.nsecsElapsed() / 1e9;
+                return m;
+            }));
+        }
+        else if (mode == "compiled") {
+            QString compiler = parser.value(compilerOption);
+            if (compiler.isEmpty()) {
+                compiler = defaultCompiler();
+            }
+            const QString programPath = dir.filePath("recognizer");
+            QElapsedTimer buildTimer;
+            buildTimer.start();
+            if (!buildRecognizer(QByteArray::fromStdString(generateRecognizer(automaton, "recognizer")), programPath,
+                                 compiler)) {
+                qWarning() << "Режим compiled пропущен";
+                continue;
+            }
+            const double buildSeconds = buildTimer.nsecsElapsed() / 1e9;
+
+            // Время включает запуск процесса и печать исходов, как при реальном использовании.
+            QJsonObject entry = measure(mode, repeat, corpusSymbols, [&] {
+                Measurement m;
+                QElapsedTimer timer;
+                timer.start();
+                QByteArray output;
+                runRecognizer(programPath, corpusPath, output);
+                m.seconds = timer.nsecsElapsed() / 1e9;
+                m.steps = profile.steps();
+                m.accepted = uint64_t(output.count("Accepted\n"));
+                return m;
+            });
+            entry["buildSeconds"] = buildSeconds;
+            // Память распознавателя — в отдельном процессе, здесь она не видна.
+            entry.remove("peakKb");
+            entry.remove("baselineKb");
+            results.append(entry);
+        }
+        else {
+            qWarning() << "Неизвестный режим:" << mode;
+        }
+    }
+
+    QJsonObject generatorInfo;
+    generatorInfo["kind"] = kind;
+    generatorInfo["seed"] = QString::number(options.seed);
+    generatorInfo["states"] = options.states;
+    generatorInfo["symbols"] = options.symbols;
+    generatorInfo["stackSymbols"] = options.stackSymbols;
+    generatorInfo["rules"] = options.rules;
+    generatorInfo["lambdaDensity"] = options.lambdaDensity;
+
+    QJsonObject automatonInfo;
+    automatonInfo["states"] = automaton.stateCount();
+    automatonInfo["symbols"] = automaton.symbolCount();
+    automatonInfo["stackSymbols"] = automaton.stackSymbolCount();
+    automatonInfo["rules"] = automaton.ruleCount();
+    automatonInfo["lambdaRules"] = generator.lambdaRules();
+    automatonInfo["unusedRules"] = double(unusedRules);
+    automatonInfo["imageBytes"] = double(automaton.imageSize());
+
+    QJsonObject corpusInfo;
+    corpusInfo["chains"] = double(chains.size());
+    corpusInfo["symbols"] = double(corpusSymbols);
+    corpusInfo["maxLength"] = double(length);
+    corpusInfo["streamSymbols"] = double(longChain.size());
+
+    QJsonObject loadInfo;
+    loadInfo["parseSeconds"] = best.loadSeconds;
+    loadInfo["compileSeconds"] = best.compileSeconds;
+    loadInfo["imageSeconds"] = imageSeconds;
+
+    QJsonObject profileInfo;
+    profileInfo["steps"] = double(profile.steps());
+    profileInfo["inputMoves"] = double(profile.inputMoves);
+    profileInfo["lambdaMoves"] = double(profile.lambdaMoves);
+    profileInfo["stepsPerSymbol"] = profile.stepsPerSymbol();
+    profileInfo["maxDepth"] = double(profile.maxDepth);
+    profileInfo["meanDepth"] = profile.meanDepth();
+    profileInfo["accepted"] = double(profile.accepted);
+
+    QJsonObject root;
+    root["generator"] = generatorInfo;
+    root["automaton"] = automatonInfo;
+    root["corpus"] = corpusInfo;
+    root["load"] = loadInfo;
+    root["profile"] = profileInfo;
+    root["modes"] = results;
+    const QByteArray json = QJsonDocument(root).toJson();
+
+    if (parser.isSet(outputOption)) {
+        return writeFile(parser.value(outputOption), json) ? 0 : 1;
+    }
+    std::fwrite(json.constData(), 1, size_t(json.size()), stdout);
+    return 0;
+}
@@ -0,0 +1,24 @@
+QT = core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = machine-bench
+
+include(../engine.pri)
+
+SOURCES += \
+    ../bench.cpp \
+    ../recognizercheck.cpp \
+    ../recognizergenerator.cpp \
+    ../workloadgenerator.cpp
+
+HEADERS += \
+    ../recognizercheck.h \
+    ../recognizergenerator.h \
+    ../workloadgenerator.h
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
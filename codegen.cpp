@@ -0,0 +1,83 @@
+#include "configloader.h"
+#include "recognizercheck.h"
+#include "recognizergenerator.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+
+#include <cstdio>
+
+namespace {
+
+bool writeFile(const QString& filePath, const QByteArray& data)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Не удалось открыть файл:" << filePath;
+        return false;
+    }
+    return file.write(data) == data.size();
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("machine-codegen");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Порождает распознаватель на C++, специализированный под заданный ДМПА.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("config", "Файл конфигурации автомата (JSON) или его образ (*.pdaimg).");
+    QCommandLineOption outputOption({"o", "output"}, "Файл для исходного текста (по умолчанию stdout).", "file");
+    QCommandLineOption namespaceOption("namespace", "Пространство имён распознавателя.", "name", "recognizer");
+    QCommandLineOption verifyOption("verify", "Собрать распознаватель и сравнить его исходы с интерпретатором на цепочках из файла.", "inputs");
+    QCommandLineOption compilerOption("compiler", "Компилятор C++ для --verify (по умолчанию $CXX или c++).", "path");
+    parser.addOption(outputOption);
+    parser.addOption(namespaceOption);
+    parser.addOption(verifyOption);
+    parser.addOption(compilerOption);
+    parser.process(app);
+
+    const QStringList arguments = parser.positionalArguments();
+    if (arguments.size() != 1) {
+        parser.showHelp(1);
+    }
+
+    const QString space = parser.value(namespaceOption);
+    if (!isIdentifier(space.toStdString())) {
+        qWarning() << "Имя пространства имён не является идентификатором C++:" << space;
+        return 1;
+    }
+
+    Automaton automaton;
+    if (!loadAutomaton(arguments[0], automaton, false)) {
+        return 1;
+    }
+    if (!automaton.isDeterministic()) {
+        qWarning() << "Автомат недетерминирован: для каждого ключа используется последнее правило.";
+    }
+
+    const QByteArray source = QByteArray::fromStdString(generateRecognizer(automaton, space.toStdString()));
+
+    if (parser.isSet(outputOption)) {
+        if (!writeFile(parser.value(outputOption), source)) {
+            return 1;
+        }
+    }
+    else if (!parser.isSet(verifyOption)) {
+        std::fwrite(source.constData(), 1, size_t(source.size()), stdout);
+    }
+
+    if (parser.isSet(verifyOption)) {
+        QString compiler = parser.value(compilerOption);
+        if (compiler.isEmpty()) {
+            compiler = defaultCompiler();
+        }
+        return verifyRecognizer(automaton, source, parser.value(verifyOption), compiler) ? 0 : 1;
+    }
+    return 0;
+}
@@ -0,0 +1,22 @@
+QT = core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = machine-codegen
+
+include(../engine.pri)
+
+SOURCES += \
+    ../codegen.cpp \
+    ../recognizercheck.cpp \
+    ../recognizergenerator.cpp
+
+HEADERS += \
+    ../recognizercheck.h \
+    ../recognizergenerator.h
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
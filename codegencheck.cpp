@@ -0,0 +1,139 @@
+#include "configloader.h"
+#include "recognizercheck.h"
+#include "recognizergenerator.h"
+#include "workloadgenerator.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <cstdio>
+
+namespace {
+
+const qsizetype MaxExhaustiveChains = 20000;
+
+// Все цепочки над алфавитом автомата по возрастанию длины, пока их не больше MaxExhaustiveChains,
+// и цепочка с символом вне алфавита.
+QByteArray exhaustiveChains(const Automaton& automaton)
+{
+    QStringList letters;
+    for (int32_t symbol = 0; symbol < automaton.knownSymbolCount(); ++symbol) {
+        const std::u16string_view name = automaton.symbolName(symbol);
+        if (symbol != automaton.lambda() && name.size() == 1) {
+            letters.append(QString::fromUtf16(name.data(), name.size()));
+        }
+    }
+
+    QByteArray text = "\n#\n";
+    QStringList level{QString()};
+    qsizetype count = 2;
+    while (!letters.isEmpty() && count + level.size() * letters.size() <= MaxExhaustiveChains) {
+        QStringList longer;
+        for (const QString& prefix : level) {
+            for (const QString& letter : letters) {
+                longer.append(prefix + letter);
+                text += (prefix + letter).toUtf8() + '\n';
+            }
+        }
+        count += longer.size();
+        level = longer;
+    }
+    return text;
+}
+
+bool check(const QString& name, const Automaton& automaton, const QByteArray& chains, const QString& compiler)
+{
+    QTemporaryDir dir;
+    const QString inputsPath = dir.filePath("chains.txt");
+    QFile inputs(inputsPath);
+    if (!dir.isValid() || !inputs.open(QIODevice::WriteOnly) || inputs.write(chains) != chains.size()) {
+        qWarning() << "Не удалось записать цепочки для" << name;
+        return false;
+    }
+    inputs.close();
+
+    std::fprintf(stderr, "%s: ", qPrintable(name));
+    const QByteArray source = QByteArray::fromStdString(generateRecognizer(automaton, "recognizer"));
+    const bool ok = verifyRecognizer(automaton, source, inputsPath, compiler);
+    if (!ok) {
+        std::fprintf(stderr, "%s: РАСХОЖДЕНИЕ\n", qPrintable(name));
+    }
+    return ok;
+}
+
+}
+
+// Перекрёстная проверка machine-codegen: распознаватели для примеров из configs/ и для
+// порождённых автоматов собираются компилятором и сравниваются с Engine.
+// Запускается через make check.
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("codegen-check");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Сравнивает порождённые распознаватели с интерпретатором.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("configs", "Каталог с примерами конфигураций (по умолчанию configs/ репозитория).");
+    QCommandLineOption compilerOption("compiler", "Компилятор C++ (по умолчанию $CXX или c++).", "path");
+    parser.addOption(compilerOption);
+    parser.process(app);
+
+    const QString compiler = parser.isSet(compilerOption) ? parser.value(compilerOption) : defaultCompiler();
+    const QString configsPath = parser.positionalArguments().value(0, CONFIGS_DIR);
+    const QDir configs(configsPath);
+    const QStringList files = configs.entryList({"*.json"}, QDir::Files, QDir::Name);
+    if (files.isEmpty()) {
+        qWarning() << "Нет конфигураций в" << configsPath;
+        return 1;
+    }
+
+    int failed = 0;
+    for (const QString& file : files) {
+        Automaton automaton;
+        if (!loadAutomaton(configs.filePath(file), automaton, false)) {
+            ++failed;
+            continue;
+        }
+        failed += !check(file, automaton, exhaustiveChains(automaton), compiler);
+    }
+
+    // Порождённые автоматы: длинные push, λ-правила в случайных местах, глубокий стек и λ-цепочки.
+    const struct {
+        const char* name;
+        WorkloadOptions::Kind kind;
+        int32_t states;
+        uint64_t seed;
+    } generated[] = {
+        {"random-1", WorkloadOptions::Kind::Random, 6, 1},
+        {"random-2", WorkloadOptions::Kind::Random, 6, 2},
+        {"random-3", WorkloadOptions::Kind::Random, 6, 3},
+        {"palindrome", WorkloadOptions::Kind::Palindrome, 3, 1},
+        {"lambda", WorkloadOptions::Kind::Lambda, 4, 1},
+    };
+    for (const auto& entry : generated) {
+        WorkloadOptions options;
+        options.kind = entry.kind;
+        options.states = entry.states;
+        options.symbols = 3;
+        options.stackSymbols = 4;
+        options.rules = 60;
+        options.lambdaDensity = 0.3;
+        options.seed = entry.seed;
+        WorkloadGenerator generator(options);
+        const Automaton automaton = Automaton::compile(generator.spec());
+
+        QByteArray chains = exhaustiveChains(automaton);
+        for (int i = 0; i < 2000; ++i) {
+            chains += QString::fromStdU16String(generator.chain(size_t(1 + i % 64))).toUtf8() + '\n';
+        }
+        failed += !check(entry.name, automaton, chains, compiler);
+    }
+
+    std::fprintf(stderr, failed ? "ошибок: %d\n" : "все распознаватели совпадают с интерпретатором\n", failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,21 @@
+QT = core
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = codegen-check
+
+include(../engine.pri)
+
+DEFINES += CONFIGS_DIR=\\\"$$PWD/../configs\\\"
+
+SOURCES += \
+    ../codegencheck.cpp \
+    ../recognizercheck.cpp \
+    ../recognizergenerator.cpp \
+    ../workloadgenerator.cpp
+
+HEADERS += \
+    ../recognizercheck.h \
+    ../recognizergenerator.h \
+    ../workloadgenerator.h
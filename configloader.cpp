@@ -0,0 +1,233 @@
+#include "configloader.h"
+#include <algorithm>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QSaveFile>
+
+// Сообщает об ошибке загрузки в журнал и, если задано, вызывающему.
+static bool fail(QString *error, const QString& message)
+{
+    qWarning().noquote() << message;
+    if (error) {
+        *error = message;
+    }
+    return false;
+}
+
+static bool readStringArray(const QJsonObject& jsonObj, const QString& key, std::vector<std::u16string>& out, QString *error)
+{
+    if (!jsonObj.contains(key) || !jsonObj[key].isArray()) {
+        return fail(error, "Массив '" + key + "' не найден или не является массивом!");
+    }
+    QJsonArray array = jsonObj[key].toArray();
+    out.clear();
+    for (const QJsonValue &value : array) {
+        if (value.isString()) {
+            out.push_back(value.toString().toStdU16String());
+        }
+    }
+    return true;
+}
+
+static bool readFile(const QString& filePath, QByteArray& fileData, QString *error)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return fail(error, "Не удалось открыть файл: " + filePath);
+    }
+
+    fileData = file.readAll();
+    file.close();
+    return true;
+}
+
+static Automaton mapAutomatonImage(const QString& imagePath)
+{
+    auto file = std::make_shared<QFile>(imagePath);
+    if (!file->open(QIODevice::ReadOnly)) {
+        return Automaton();
+    }
+    const qint64 size = file->size();
+    const uchar* data = file->map(0, size);
+    if (!data) {
+        return Automaton();
+    }
+    return Automaton::fromImage(file, reinterpret_cast<const char*>(data), size_t(size));
+}
+
+bool loadAutomatonSpec(const QString& filePath, AutomatonSpec& spec, QString *error)
+{
+    QByteArray fileData;
+    return readFile(filePath, fileData, error) && parseAutomatonSpec(fileData, spec, error);
+}
+
+QString automatonImagePath(const QString& configPath)
+{
+    const QFileInfo info(configPath);
+    return info.dir().filePath(info.completeBaseName() + ".pdaimg");
+}
+
+bool saveAutomatonImage(const Automaton& automaton, const QString& imagePath)
+{
+    QSaveFile file(imagePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(automaton.image(), qint64(automaton.imageSize()));
+    return file.commit();
+}
+
+bool loadAutomaton(const QString& filePath, Automaton& automaton, bool useImage, LoadTimings *timings, QString *error)
+{
+    LoadTimings ignored;
+    if (!timings) {
+        timings = &ignored;
+    }
+    *timings = LoadTimings();
+    QElapsedTimer timer;
+    timer.start();
+
+    if (filePath.endsWith(".pdaimg")) {
+        Automaton image = mapAutomatonImage(filePath);
+        timings->loadSeconds = timer.nsecsElapsed() / 1e9;
+        if (image.isEmpty()) {
+            return fail(error, "Образ повреждён или собран другой версией: " + filePath);
+        }
+        automaton = std::move(image);
+        reportLambdaCycles(automaton);
+        return true;
+    }
+
+    QByteArray fileData;
+    if (!readFile(filePath, fileData, error)) {
+        return false;
+    }
+    const uint64_t checksum = Automaton::checksum(fileData.constData(), size_t(fileData.size()));
+    const QString imagePath = automatonImagePath(filePath);
+
+    if (useImage) {
+        Automaton image = mapAutomatonImage(imagePath);
+        if (!image.isEmpty() && image.sourceChecksum() == checksum) {
+            timings->loadSeconds = timer.nsecsElapsed() / 1e9;
+            automaton = std::move(image);
+            reportLambdaCycles(automaton);
+            return true;
+        }
+        if (image.isEmpty() && QFileInfo::exists(imagePath)) {
+            qWarning() << "Образ повреждён или собран другой версией, автомат собирается заново:" << imagePath;
+        }
+    }
+
+    AutomatonSpec spec;
+    if (!parseAutomatonSpec(fileData, spec, error)) {
+        return false;
+    }
+    timings->loadSeconds = timer.nsecsElapsed() / 1e9;
+    timer.restart();
+    automaton = Automaton::compile(spec, checksum);
+    timings->compileSeconds = timer.nsecsElapsed() / 1e9;
+    reportLambdaCycles(automaton);
+
+    if (useImage && !saveAutomatonImage(automaton, imagePath)) {
+        qWarning() << "Не удалось сохранить образ:" << imagePath;
+    }
+    return true;
+}
+
+void reportLambdaCycles(const Automaton& automaton)
+{
+    if (automaton.divergentPairs() == 0) {
+        return;
+    }
+    QStringList pairs;
+    for (int32_t state = 0; state < automaton.stateCount() && pairs.size() < 5; ++state) {
+        for (int32_t top = 0; top < automaton.stackSymbolCount() && pairs.size() < 5; ++top) {
+            const Automaton::LambdaSummary* summary = automaton.lambdaSummary(state, top);
+            if (summary && summary->kind == Automaton::LambdaSummary::Diverges) {
+                const std::u16string_view stateName = automaton.stateName(state);
+                const std::u16string_view topName = automaton.stackSymbolName(top);
+                pairs.append(QString("(%1, %2)").arg(QString::fromUtf16(stateName.data(), stateName.size()),
+                                                     QString::fromUtf16(topName.data(), topName.size())));
+            }
+        }
+    }
+    qWarning() << "λ-переходы не завершаются из" << automaton.divergentPairs()
+               << "пар (состояние, вершина), например:" << pairs.join(", ");
+}
+
+bool parseAutomatonSpec(const QByteArray& fileData, AutomatonSpec& spec, QString *error)
+{
+    QJsonParseError parseError;
+    QJsonDocument jsonDoc = QJsonDocument::fromJson(fileData, &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        return fail(error, "Ошибка парсинга JSON: " + parseError.errorString());
+    }
+
+    if (!jsonDoc.isObject()) {
+        return fail(error, "JSON не является объектом!");
+    }
+
+    QJsonObject jsonObj = jsonDoc.object();
+
+    if (!readStringArray(jsonObj, "states", spec.states, error)) {
+        return false;
+    }
+
+    if (!readStringArray(jsonObj, "alphabet", spec.alphabet, error)) {
+        return false;
+    }
+    if (std::find(spec.alphabet.begin(), spec.alphabet.end(), u"λ") == spec.alphabet.end()) {
+        spec.alphabet.push_back(u"λ");
+    }
+
+    if (!readStringArray(jsonObj, "in_stack", spec.inStack, error)) {
+        return false;
+    }
+
+    if (jsonObj.contains("rules") && jsonObj["rules"].isArray()) {
+        QJsonArray rulesArray = jsonObj["rules"].toArray();
+        spec.rules.clear();
+        spec.rules.reserve(rulesArray.size());
+
+        for (const QJsonValue &value : rulesArray) {
+            if (!value.isArray()) {
+                return fail(error, "Элемент не является массивом!");
+            }
+
+            QJsonArray rule = value.toArray();
+            if (rule.size() != 5) {
+                return fail(error, "Неверный размер массива правила!");
+            }
+            spec.rules.push_back({rule[0].toString().toStdU16String(),
+                                  rule[1].toString().toStdU16String(),
+                                  rule[2].toString().toStdU16String(),
+                                  rule[3].toString().toStdU16String(),
+                                  rule[4].toString().toStdU16String()});
+        }
+    }
+    else{
+        return fail(error, "Массив 'rules' не найден или не является массивом!");
+    }
+
+    if (jsonObj.contains("start") && jsonObj["start"].isString()) {
+        spec.start = jsonObj["start"].toString().toStdU16String();
+    }
+    else{
+        return fail(error, "значение 'start' не найден или не является массивом!");
+    }
+
+    if (jsonObj.contains("start_stack") && jsonObj["start_stack"].isString()) {
+        spec.startStack = jsonObj["start_stack"].toString().toStdU16String();
+    }
+    else{
+        return fail(error, "значение 'start_stack' не найден или не является массивом!");
+    }
+
+    return readStringArray(jsonObj, "ends", spec.ends, error);
+}
@@ -0,0 +1,33 @@
+#ifndef CONFIGLOADER_H
+#define CONFIGLOADER_H
+
+#include <QByteArray>
+#include <QString>
+
+#include "automaton.h"
+
+// При ошибке её текст пишется в журнал и, если задан error, возвращается в нём.
+bool parseAutomatonSpec(const QByteArray& fileData, AutomatonSpec& spec, QString *error = nullptr);
+bool loadAutomatonSpec(const QString& filePath, AutomatonSpec& spec, QString *error = nullptr);
+
+// Путь к бинарному образу, который кэширует скомпилированную конфигурацию.
+QString automatonImagePath(const QString& configPath);
+bool saveAutomatonImage(const Automaton& automaton, const QString& imagePath);
+
+// Время этапов загрузки: чтение и разбор файла (или отображение образа) и компиляция таблиц.
+struct LoadTimings
+{
+    double loadSeconds = 0;
+    double compileSeconds = 0;
+};
+
+// Загружает автомат из JSON или из готового образа (*.pdaimg).
+// Для JSON используется образ рядом с ним, если его контрольная сумма совпадает с исходником;
+// иначе конфигурация разбирается заново, а образ пересобирается.
+bool loadAutomaton(const QString& filePath, Automaton& automaton, bool useImage = true, LoadTimings *timings = nullptr,
+                   QString *error = nullptr);
+
+// Предупреждает о парах (состояние, вершина), из которых λ-переходы не завершаются.
+void reportLambdaCycles(const Automaton& automaton);
+
+#endif // CONFIGLOADER_H
@@ -0,0 +1,136 @@
+#include "engine.h"
+
+Engine::Engine(const Automaton& automaton)
+    : automaton(&automaton)
+{
+    reset();
+}
+
+void Engine::reset()
+{
+    current = automaton->startState();
+    symbols.clear();
+    symbols.push(automaton->startStackSymbol());
+    applied = Automaton::NoTransition;
+    stepCount = 0;
+    result = Outcome::Running;
+}
+
+void Engine::restore(const Snapshot& snapshot)
+{
+    current = snapshot.state;
+    symbols = snapshot.stack;
+    applied = snapshot.applied;
+    stepCount = snapshot.steps;
+    result = snapshot.result;
+}
+
+Engine::Outcome Engine::reject(int32_t symbol, int32_t top)
+{
+    if (!automaton->isKnownState(current)) {
+        result = Outcome::UnknownState;
+    }
+    else if (!automaton->isKnownSymbol(symbol)) {
+        result = Outcome::UnknownSymbol;
+    }
+    else if (!automaton->isKnownStackSymbol(top)) {
+        result = Outcome::UnknownStackSymbol;
+    }
+    else {
+        result = Outcome::NoRule;
+    }
+    return result;
+}
+
+Engine::Outcome Engine::step(int32_t symbol)
+{
+    if (isHalted() || symbols.empty()) {
+        return result;
+    }
+
+    const int32_t top = symbols.top();
+    const int32_t index = automaton->transition(current, symbol, top);
+    if (index == Automaton::NoTransition) {
+        applied = Automaton::NoTransition;
+        return reject(symbol, top);
+    }
+
+    const Automaton::Rule& rule = automaton->rule(index);
+    if (rule.pop) {
+        symbols.pop();
+    }
+    symbols.push(automaton->pushSequence(rule), rule.pushCount);
+
+    current = rule.next;
+    applied = index;
+    ++stepCount;
+    if (statistics) {
+        statistics->recordStep(index, symbol == automaton->lambda(), symbols.size());
+    }
+    return result;
+}
+
+Engine::Outcome Engine::feed(const char16_t* data, size_t size)
+{
+    size_t consumed = 0;
+    while (consumed < size && !isHalted()) {
+        if (symbols.empty()) {
+            result = Outcome::InputLeft;
+            break;
+        }
+        if (step(automaton->inputSymbol(data[consumed])) != Outcome::Running) {
+            break;
+        }
+        ++consumed;
+    }
+    if (statistics) {
+        // Считаются только прочитанные символы: отвергнутый и оставшиеся после останова не входят.
+        statistics->inputSymbols += consumed;
+    }
+    return result;
+}
+
+bool Engine::lambdaDiverges() const
+{
+    if (symbols.empty()) {
+        return false;
+    }
+    const Automaton::LambdaSummary* summary = automaton->lambdaSummary(current, symbols.top());
+    return summary && summary->kind == Automaton::LambdaSummary::Diverges;
+}
+
+Engine::Outcome Engine::finish()
+{
+    while (!isHalted() && !symbols.empty()) {
+        const Automaton::LambdaSummary* summary = automaton->lambdaSummary(current, symbols.top());
+        if (summary && summary->kind == Automaton::LambdaSummary::Pops && !statistics) {
+            symbols.pop();
+            current = summary->next;
+            stepCount = stepCount > UINT64_MAX - summary->steps ? UINT64_MAX : stepCount + summary->steps;
+        }
+        else if (summary && summary->kind == Automaton::LambdaSummary::Diverges) {
+            result = Outcome::Diverges;
+        }
+        else {
+            // Вычисление застрянет либо ведётся статистика: идём по шагам, чтобы сообщить
+            // ошибку точно и учесть каждое правило.
+            step(automaton->lambda());
+        }
+    }
+    if (!isHalted()) {
+        result = automaton->isFinal(current) ? Outcome::Accepted : Outcome::NotFinalState;
+    }
+    return result;
+}
+
+Engine::Outcome Engine::run(std::u16string_view input)
+{
+    reset();
+    feed(input.data(), input.size());
+    finish();
+    if (statistics) {
+        ++statistics->runs;
+        statistics->accepted += result == Outcome::Accepted;
+    }
+    return result;
+}
@@ -0,0 +1,78 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include "automaton.h"
+#include "pdastack.h"
+#include "runstatistics.h"
+
+#include <string_view>
+
+// Исполнитель ДМПА над скомпилированным автоматом, не зависящий от интерфейса.
+// Входная цепочка подаётся кусками через feed(), λ-переходы выполняются в finish().
+// finish() снимает символы стека по готовым сводкам λ-переходов, поэтому делает не больше
+// итераций, чем глубина стека, и сразу сообщает о бесконечном цикле λ-переходов.
+class Engine
+{
+public:
+    enum class Outcome {
+        Running,
+        Accepted,
+        UnknownState,
+        UnknownSymbol,
+        UnknownStackSymbol,
+        NoRule,
+        InputLeft,
+        NotFinalState,
+        Diverges
+    };
+
+    // Конфигурация исполнителя, по которой можно вернуться к этому шагу.
+    struct Snapshot
+    {
+        int32_t state;
+        PdaStack stack;
+        int32_t applied;
+        uint64_t steps;
+        Outcome result;
+    };
+
+    explicit Engine(const Automaton& automaton);
+
+    void reset();
+    // Включает подсчёт статистики (nullptr — выключает). С ней finish() выполняет
+    // λ-переходы по одному, чтобы учесть каждое правило.
+    void setStatistics(RunStatistics* statistics) { this->statistics = statistics; }
+    Snapshot snapshot() const { return {current, symbols, applied, stepCount, result}; }
+    void restore(const Snapshot& snapshot);
+
+    // Один переход по символу symbol (номер входного символа или lambda()).
+    Outcome step(int32_t symbol);
+
+    Outcome feed(const char16_t* data, size_t size);
+    Outcome finish();
+    Outcome run(std::u16string_view input);
+
+    // Цепочка λ-переходов из текущей конфигурации никогда не закончится.
+    bool lambdaDiverges() const;
+
+    Outcome outcome() const { return result; }
+    bool isHalted() const { return result != Outcome::Running; }
+
+    int32_t state() const { return current; }
+    const PdaStack& stack() const { return symbols; }
+    int32_t lastRule() const { return applied; }
+    uint64_t steps() const { return stepCount; }
+
+private:
+    const Automaton* automaton;
+    int32_t current = 0;
+    PdaStack symbols;
+    int32_t applied = Automaton::NoTransition;
+    uint64_t stepCount = 0;
+    Outcome result = Outcome::Running;
+    RunStatistics* statistics = nullptr;
+
+    Outcome reject(int32_t symbol, int32_t top);
+};
+
+#endif // ENGINE_H
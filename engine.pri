@@ -0,0 +1,29 @@
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/automaton.cpp \
+    $$PWD/configloader.cpp \
+    $$PWD/engine.cpp \
+    $$PWD/executiontrace.cpp \
+    $$PWD/incrementalrecognizer.cpp \
+    $$PWD/inputstream.cpp \
+    $$PWD/lockstepbatch.cpp \
+    $$PWD/nondeterministicsearch.cpp \
+    $$PWD/runstatistics.cpp \
+    $$PWD/workstealingpool.cpp
+
+HEADERS += \
+    $$PWD/automaton.h \
+    $$PWD/configloader.h \
+    $$PWD/engine.h \
+    $$PWD/executiontrace.h \
+    $$PWD/incrementalrecognizer.h \
+    $$PWD/inputstream.h \
+    $$PWD/lockstepbatch.h \
+    $$PWD/nondeterministicsearch.h \
+    $$PWD/pdastack.h \
+    $$PWD/runstatistics.h \
+    $$PWD/workstealingpool.h
+
+# Векторный поиск правил в LockstepBatch: qmake CONFIG+=lockstep_avx2 (только для процессоров с AVX2).
+lockstep_avx2: QMAKE_CXXFLAGS += $$QMAKE_CFLAGS_AVX2
@@ -0,0 +1,83 @@
+#include "executiontrace.h"
+
+#include <algorithm>
+
+ExecutionTrace::ExecutionTrace(size_t capacity)
+    : records(std::max<size_t>(capacity, 1))
+{
+}
+
+void ExecutionTrace::clear()
+{
+    head = 0;
+    count = 0;
+    total = 0;
+}
+
+void ExecutionTrace::append(const TraceRecord& record)
+{
+    if (count < records.size()) {
+        records[(head + count) % records.size()] = record;
+        ++count;
+    }
+    else {
+        records[head] = record;
+        head = (head + 1) % records.size();
+    }
+    ++total;
+}
+
+void ExecutionTrace::dropFront(size_t count)
+{
+    count = std::min(count, this->count);
+    head = (head + count) % records.size();
+    this->count -= count;
+}
+
+size_t ExecutionTrace::lowerBound(uint64_t step) const
+{
+    size_t first = 0;
+    size_t length = count;
+    while (length > 0) {
+        const size_t half = length / 2;
+        if (at(first + half).step < step) {
+            first += half + 1;
+            length -= half + 1;
+        }
+        else {
+            length = half;
+        }
+    }
+    return first;
+}
+
+namespace {
+
+void appendNumber(std::u16string& text, uint64_t value)
+{
+    const std::string digits = std::to_string(value);
+    text.append(digits.begin(), digits.end());
+}
+
+}
+
+std::u16string describeTraceRecord(const Automaton& automaton, const TraceRecord& record)
+{
+    std::u16string text;
+    appendNumber(text, record.step);
+    text += u": δ(";
+    text += automaton.stateName(record.state);
+    text += u", ";
+    text += automaton.symbolName(record.symbol);
+    text += u", ";
+    text += automaton.stackSymbolName(record.top);
+    text += u") -> (";
+    text += automaton.stateName(automaton.rule(record.rule).next);
+    text += u", ";
+    text += automaton.pushText(record.rule);
+    text += u"), позиция ";
+    appendNumber(text, record.position);
+    text += u", глубина стека ";
+    appendNumber(text, record.depth);
+    return text;
+}
@@ -0,0 +1,65 @@
+#ifndef EXECUTIONTRACE_H
+#define EXECUTIONTRACE_H
+
+#include "automaton.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Один выполненный переход: конфигурация до шага и применённое правило.
+// Изменение стека восстанавливается по правилу, поэтому стек целиком не хранится.
+struct TraceRecord
+{
+    uint64_t step;
+    uint64_t position;
+    uint64_t depth;
+    int32_t state;
+    int32_t symbol;
+    int32_t top;
+    int32_t rule;
+};
+
+enum class TraceLevel {
+    None,
+    Input,
+    Transitions
+};
+
+// Кольцевой буфер последних capacity() записей трассы; более старые вытесняются.
+class ExecutionTrace
+{
+public:
+    explicit ExecutionTrace(size_t capacity);
+
+    // Попадает ли шаг в трассу данного уровня; reading — шаг читает входной символ.
+    static bool accepts(TraceLevel level, bool reading)
+    {
+        return level == TraceLevel::Transitions || (level == TraceLevel::Input && reading);
+    }
+
+    void clear();
+    void append(const TraceRecord& record);
+    // Вытесняет count самых старых записей.
+    void dropFront(size_t count);
+
+    size_t size() const { return count; }
+    size_t capacity() const { return records.size(); }
+    uint64_t dropped() const { return total - count; }
+
+    // 0 — самая старая из сохранённых записей.
+    const TraceRecord& at(size_t index) const { return records[(head + index) % records.size()]; }
+    // Индекс первой записи с шагом не меньше step либо size().
+    size_t lowerBound(uint64_t step) const;
+
+private:
+    std::vector<TraceRecord> records;
+    size_t head = 0;
+    size_t count = 0;
+    uint64_t total = 0;
+};
+
+// Строка трассы вида "12: δ(q0, a, Z) -> (q1, AZ), позиция 3, глубина стека 4".
+std::u16string describeTraceRecord(const Automaton& automaton, const TraceRecord& record);
+
+#endif // EXECUTIONTRACE_H
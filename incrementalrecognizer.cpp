@@ -0,0 +1,86 @@
+#include "incrementalrecognizer.h"
+
+#include <algorithm>
+
+namespace {
+
+const size_t FirstInterval = 256;
+// Сколько ячеек стека суммарно хранят снимки; при превышении каждый второй снимок удаляется.
+const size_t MaxCheckpointCells = size_t(1) << 22;
+
+}
+
+IncrementalRecognizer::IncrementalRecognizer(const Automaton& automaton)
+    : automaton(automaton)
+    , engine(this->automaton)
+    , interval(FirstInterval)
+{
+    clear();
+}
+
+void IncrementalRecognizer::clear()
+{
+    input.clear();
+    checkpoints.clear();
+    checkpointCells = 0;
+    interval = FirstInterval;
+    haltEnd = 0;
+    engine.reset();
+    addCheckpoint(0);
+}
+
+Engine::Outcome IncrementalRecognizer::evaluate(std::u16string_view text)
+{
+    const size_t prefix = size_t(std::mismatch(input.begin(), input.end(), text.begin(), text.end()).first - input.begin());
+    input.assign(text);
+    fed = 0;
+
+    // Символ, на котором исполнитель остановился, не изменился: исход тот же.
+    if (haltEnd > 0 && prefix >= haltEnd) {
+        return haltOutcome;
+    }
+    haltEnd = 0;
+
+    while (checkpoints.size() > 1 && checkpoints.back().position > prefix) {
+        checkpointCells -= checkpoints.back().snapshot.stack.cellCount();
+        checkpoints.pop_back();
+    }
+    engine.restore(checkpoints.back().snapshot);
+    size_t position = checkpoints.back().position;
+
+    while (position < input.size()) {
+        const size_t block = std::min(interval - position % interval, input.size() - position);
+        engine.feed(input.data() + position, block);
+        fed += block;
+        position += block;
+        if (engine.isHalted()) {
+            haltEnd = position;
+            haltOutcome = engine.outcome();
+            return haltOutcome;
+        }
+        if (position % interval == 0) {
+            addCheckpoint(position);
+        }
+    }
+    return engine.finish();
+}
+
+void IncrementalRecognizer::addCheckpoint(size_t position)
+{
+    checkpoints.push_back({position, engine.snapshot()});
+    checkpointCells += engine.stack().cellCount();
+    if (checkpointCells <= MaxCheckpointCells) {
+        return;
+    }
+
+    // Прореживание: остаются снимки на позициях, кратных удвоенному интервалу.
+    interval *= 2;
+    checkpointCells = 0;
+    auto kept = std::remove_if(checkpoints.begin(), checkpoints.end(), [this](const Checkpoint& checkpoint) {
+        return checkpoint.position % interval != 0;
+    });
+    checkpoints.erase(kept, checkpoints.end());
+    for (const auto& checkpoint : checkpoints) {
+        checkpointCells += checkpoint.snapshot.stack.cellCount();
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef INCREMENTALRECOGNIZER_H
+#define INCREMENTALRECOGNIZER_H
+
+#include "engine.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Проверяет цепочку повторно после правки, не начиная с нуля.
+// Во время прогона сохраняются снимки исполнителя на позициях входа, кратных interval;
+// следующий вызов evaluate() продолжает с последнего снимка внутри общего префикса
+// старой и новой цепочек, поэтому правка стоит примерно столько, сколько изменённый хвост.
+class IncrementalRecognizer
+{
+public:
+    explicit IncrementalRecognizer(const Automaton& automaton);
+    IncrementalRecognizer(const IncrementalRecognizer&) = delete;
+    IncrementalRecognizer& operator=(const IncrementalRecognizer&) = delete;
+
+    Engine::Outcome evaluate(std::u16string_view input);
+    void clear();
+
+    // Сколько символов было подано в исполнитель при последнем вызове evaluate().
+    size_t lastFed() const { return fed; }
+
+private:
+    struct Checkpoint
+    {
+        size_t position;
+        Engine::Snapshot snapshot;
+    };
+
+    Automaton automaton;
+    Engine engine;
+    std::u16string input;
+    std::vector<Checkpoint> checkpoints;
+    size_t interval;
+    size_t checkpointCells = 0;
+    // Исполнитель остановился на символе из блока, заканчивающегося здесь; 0 — не останавливался.
+    size_t haltEnd = 0;
+    Engine::Outcome haltOutcome = Engine::Outcome::Running;
+    size_t fed = 0;
+
+    void addCheckpoint(size_t position);
+};
+
+#endif // INCREMENTALRECOGNIZER_H
@@ -0,0 +1,114 @@
+#include "inputstream.h"
+
+#include <QDebug>
+#include <QStringDecoder>
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+bool InputStream::open(const QString& path)
+{
+    position = 0;
+    failed = false;
+    mapped = nullptr;
+
+    const bool opened = path == "-" ? file.open(stdin, QIODevice::ReadOnly) : file.open(QIODevice::ReadOnly);
+    if (!opened) {
+        qWarning() << "Не удалось открыть файл:" << path;
+        return false;
+    }
+    if (!file.isSequential() && file.size() > 0) {
+        mappedSize = file.size();
+        mapped = file.map(0, mappedSize);
+    }
+    if (!mapped) {
+        buffer.resize(ChunkSize);
+    }
+    return true;
+}
+
+bool InputStream::read(const char*& data, qint64& size)
+{
+    if (failed) {
+        return false;
+    }
+    if (mapped) {
+        size = std::min(ChunkSize, mappedSize - position);
+        data = reinterpret_cast<const char*>(mapped) + position;
+        position += size;
+        return size > 0;
+    }
+
+    size = file.read(buffer.data(), ChunkSize);
+    if (size < 0) {
+        qWarning() << "Ошибка чтения входа:" << file.errorString();
+        failed = true;
+        return false;
+    }
+    data = buffer.constData();
+    position += size;
+    return size > 0;
+}
+
+namespace {
+
+// Обрывается ли последовательность UTF-8 на последнем байте: ведущий байт среди последних трёх
+// обещает больше байтов, чем осталось до конца.
+bool endsInsideSymbol(const QByteArray& tail)
+{
+    for (qsizetype back = 1; back <= tail.size(); ++back) {
+        const uchar byte = uchar(tail[tail.size() - back]);
+        if ((byte & 0xC0) != 0x80) {
+            const qsizetype length = byte >= 0xF0 ? 4 : byte >= 0xE0 ? 3 : byte >= 0xC0 ? 2 : 1;
+            return length > back;
+        }
+    }
+    return false;
+}
+
+}
+
+Engine::Outcome recognizeStream(Engine& engine, InputStream& stream)
+{
+    QStringDecoder decoder(QStringDecoder::Utf8);
+    std::vector<char16_t> text;
+    // Перевод строки в конце куска придерживается до следующего куска:
+    // если кусок окажется последним, он отбрасывается.
+    size_t held = 0;
+    // Последние три байта входа. Незавершённую последовательность декодер придерживает
+    // до следующего куска и в конце входа сам её не выдаёт.
+    QByteArray tail;
+
+    const char* data = nullptr;
+    qint64 size = 0;
+    while (!engine.isHalted() && stream.read(data, size)) {
+        text.resize(held + size_t(decoder.requiredSpace(size)));
+        QChar* end = decoder.appendToBuffer(reinterpret_cast<QChar*>(text.data() + held), QByteArrayView(data, size));
+        size_t length = size_t(reinterpret_cast<char16_t*>(end) - text.data());
+
+        held = 0;
+        if (length > 0 && text[length - 1] == u'\n') {
+            held = length >= 2 && text[length - 2] == u'\r' ? 2 : 1;
+        }
+        else if (length > 0 && text[length - 1] == u'\r') {
+            held = 1;
+        }
+        engine.feed(text.data(), length - held);
+        std::copy(text.begin() + (length - held), text.begin() + length, text.begin());
+        tail.append(data + size - std::min<qint64>(size, 3), std::min<qint64>(size, 3));
+        tail = tail.right(3);
+    }
+    if (stream.hasError()) {
+        return engine.outcome();
+    }
+    // Оборванный символ подаётся как U+FFFD, как его декодирует QString::fromUtf8() в machine-batch;
+    // придержанный перевод строки тогда оказывается внутри цепочки.
+    // Иначе придержанные "\n", "\r\n" или одиночный "\r" отбрасываются, как в splitLines().
+    if (!engine.isHalted() && endsInsideSymbol(tail)) {
+        text.resize(held);
+        text.push_back(u'\uFFFD');
+        engine.feed(text.data(), text.size());
+    }
+    return engine.finish();
+}
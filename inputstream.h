@@ -0,0 +1,40 @@
+#ifndef INPUTSTREAM_H
+#define INPUTSTREAM_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+#include "engine.h"
+
+// Источник входной цепочки, который читается кусками фиксированного размера.
+// Обычный файл отображается в память, стандартный ввод ("-") и каналы читаются в буфер,
+// поэтому объём памяти не зависит от длины цепочки.
+class InputStream
+{
+public:
+    static constexpr qint64 ChunkSize = qint64(1) << 20;
+
+    bool open(const QString& path);
+    // Следующий кусок байтов; false, когда вход закончился или произошла ошибка.
+    bool read(const char*& data, qint64& size);
+
+    bool hasError() const { return failed; }
+    qint64 bytesRead() const { return position; }
+
+private:
+    QFile file;
+    const uchar* mapped = nullptr;
+    qint64 mappedSize = 0;
+    qint64 position = 0;
+    QByteArray buffer;
+    bool failed = false;
+};
+
+// Подаёт в исполнитель всю цепочку из потока (UTF-8) и выполняет λ-переходы.
+// Один завершающий перевод строки ("\n", "\r\n" или "\r") не считается частью цепочки, как в
+// machine-batch; последовательность UTF-8, оборванная в конце входа, подаётся как U+FFFD.
+// Чтение прекращается, как только исход становится известен; при ошибке чтения возвращается Running.
+Engine::Outcome recognizeStream(Engine& engine, InputStream& stream);
+
+#endif // INPUTSTREAM_H
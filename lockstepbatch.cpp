@@ -0,0 +1,244 @@
+#include "lockstepbatch.h"
+
+#include <algorithm>
+#include <limits>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const size_t StackStride = LockstepBatch::MaxDepth + LockstepBatch::MaxPush + 1;
+
+}
+
+LockstepBatch::LockstepBatch(const Automaton& automaton)
+    : automaton(&automaton)
+    , states(Lanes)
+    , tops(Lanes)
+    , symbols(Lanes)
+    , rules(Lanes)
+    , depths(Lanes)
+    , cursors(Lanes)
+    , ends(Lanes)
+    , owners(Lanes)
+    , stacks(Lanes * StackStride)
+{
+    auto table = std::make_shared<std::vector<Move>>(size_t(automaton.ruleCount()));
+    for (int32_t index = 0; index < automaton.ruleCount(); ++index) {
+        const Automaton::Rule& rule = automaton.rule(index);
+        Move& move = (*table)[index];
+        move.next = rule.next;
+        move.pop = uint16_t(rule.pop);
+        // Длинные правила не проходят проверку глубины и применяются через Engine.
+        move.pushCount = uint16_t(rule.pushCount > MaxPush ? MaxDepth + 1 : rule.pushCount);
+        std::fill(std::begin(move.push), std::end(move.push), -1);
+        std::copy_n(automaton.pushSequence(rule), std::min<uint32_t>(rule.pushCount, MaxPush), move.push);
+    }
+    moveTable = table->data();
+    moves = std::move(table);
+
+    // Индекс в таблице считается в 32-битных дорожках.
+    const uint64_t tableSize = uint64_t(automaton.knownStateCount()) * uint64_t(automaton.knownStackSymbolCount())
+                               * uint64_t(automaton.knownSymbolCount());
+    vectorIndex = tableSize <= uint64_t(std::numeric_limits<int32_t>::max());
+}
+
+void LockstepBatch::run(const std::u16string_view* inputs, size_t count, Engine::Outcome* outcomes)
+{
+    this->inputs = inputs;
+    this->outcomes = outcomes;
+    this->count = count;
+    next = 0;
+    active = 0;
+
+    while (active < Lanes && next < count) {
+        load(active, next++);
+        if (prepare(active)) {
+            ++active;
+        }
+    }
+
+    while (active > 0) {
+        lookup();
+        for (size_t lane = 0; lane < active;) {
+            if (apply(lane) && prepare(lane)) {
+                ++lane;
+            }
+            else if (replace(lane)) {
+                // Новая цепочка делает первый шаг на следующем проходе.
+                ++lane;
+            }
+        }
+    }
+}
+
+// Занимает дорожку следующей цепочкой. Если цепочки кончились, на место дорожки
+// переносится последняя активная, ещё не сделавшая шаг на этом проходе, и возвращается false.
+bool LockstepBatch::replace(size_t lane)
+{
+    while (next < count) {
+        load(lane, next++);
+        if (prepare(lane)) {
+            return true;
+        }
+    }
+    move(--active, lane);
+    return false;
+}
+
+void LockstepBatch::load(size_t lane, size_t input)
+{
+    owners[lane] = input;
+    cursors[lane] = inputs[input].data();
+    ends[lane] = inputs[input].data() + inputs[input].size();
+    states[lane] = automaton->startState();
+    stacks[lane * StackStride] = -1;
+    stacks[lane * StackStride + 1] = automaton->startStackSymbol();
+    tops[lane] = automaton->startStackSymbol();
+    depths[lane] = 1;
+}
+
+void LockstepBatch::move(size_t from, size_t to)
+{
+    if (from == to) {
+        return;
+    }
+    owners[to] = owners[from];
+    cursors[to] = cursors[from];
+    ends[to] = ends[from];
+    states[to] = states[from];
+    tops[to] = tops[from];
+    symbols[to] = symbols[from];
+    rules[to] = rules[from];
+    depths[to] = depths[from];
+    std::copy_n(stacks.begin() + from * StackStride, depths[from] + 1, stacks.begin() + to * StackStride);
+}
+
+// Готовит дорожку к очередному шагу; false, если её цепочка уже получила исход.
+bool LockstepBatch::prepare(size_t lane)
+{
+    const bool reading = cursors[lane] != ends[lane];
+    if (depths[lane] == 0) {
+        if (reading) {
+            outcomes[owners[lane]] = Engine::Outcome::InputLeft;
+        }
+        else {
+            outcomes[owners[lane]] = automaton->isFinal(states[lane]) ? Engine::Outcome::Accepted
+                                                                      : Engine::Outcome::NotFinalState;
+        }
+        return false;
+    }
+    if (!reading) {
+        outcomes[owners[lane]] = finish(lane);
+        return false;
+    }
+    symbols[lane] = automaton->inputSymbol(*cursors[lane]);
+    return true;
+}
+
+void LockstepBatch::lookup()
+{
+    size_t lane = 0;
+#ifdef __AVX2__
+    if (vectorIndex) {
+        const int32_t* table = automaton->transitionTable();
+        const __m256i stateLimit = _mm256_set1_epi32(automaton->knownStateCount());
+        const __m256i symbolLimit = _mm256_set1_epi32(automaton->knownSymbolCount());
+        const __m256i stackLimit = _mm256_set1_epi32(automaton->knownStackSymbolCount());
+        const __m256i minusOne = _mm256_set1_epi32(-1);
+        for (; lane + 8 <= active; lane += 8) {
+            const __m256i state = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(states.data() + lane));
+            const __m256i symbol = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(symbols.data() + lane));
+            const __m256i top = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tops.data() + lane));
+
+            __m256i valid = _mm256_and_si256(_mm256_cmpgt_epi32(stateLimit, state), _mm256_cmpgt_epi32(stackLimit, top));
+            valid = _mm256_and_si256(valid, _mm256_cmpgt_epi32(symbolLimit, symbol));
+            valid = _mm256_and_si256(valid, _mm256_cmpgt_epi32(symbol, minusOne));
+
+            __m256i index = _mm256_add_epi32(_mm256_mullo_epi32(state, stackLimit), top);
+            index = _mm256_add_epi32(_mm256_mullo_epi32(index, symbolLimit), symbol);
+            // Для неизвестных номеров маска оставляет -1, не обращаясь к таблице.
+            index = _mm256_and_si256(index, valid);
+            const __m256i rule = _mm256_mask_i32gather_epi32(minusOne, table, index, valid, 4);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(rules.data() + lane), rule);
+        }
+    }
+#endif
+    for (; lane < active; ++lane) {
+        rules[lane] = automaton->transition(states[lane], symbols[lane], tops[lane]);
+    }
+}
+
+// Применяет найденное правило; false, если цепочка получила исход.
+bool LockstepBatch::apply(size_t lane)
+{
+    const int32_t index = rules[lane];
+    if (index == Automaton::NoTransition) {
+        outcomes[owners[lane]] = reject(lane);
+        return false;
+    }
+
+    const Move& move = moveTable[index];
+    const uint32_t depth = depths[lane] - move.pop;
+    if (depth + move.pushCount > MaxDepth) {
+        outcomes[owners[lane]] = continueInEngine(lane);
+        return false;
+    }
+
+    // Запись всех MaxPush элементов без ветвлений; лишние окажутся выше вершины.
+    int32_t* stack = stacks.data() + lane * StackStride + depth + 1;
+    for (uint32_t i = 0; i < MaxPush; ++i) {
+        stack[i] = move.push[i];
+    }
+    depths[lane] = depth + move.pushCount;
+    tops[lane] = stack[int(move.pushCount) - 1];
+    states[lane] = move.next;
+    ++cursors[lane];
+    return true;
+}
+
+// Вход исчерпан: λ-переходы выполняются по сводкам, как в Engine::finish().
+Engine::Outcome LockstepBatch::finish(size_t lane)
+{
+    const int32_t* stack = stacks.data() + lane * StackStride;
+    while (depths[lane] > 0) {
+        const Automaton::LambdaSummary* summary = automaton->lambdaSummary(states[lane], tops[lane]);
+        if (!summary || summary->kind == Automaton::LambdaSummary::Halts) {
+            return continueInEngine(lane);
+        }
+        if (summary->kind == Automaton::LambdaSummary::Diverges) {
+            return Engine::Outcome::Diverges;
+        }
+        states[lane] = summary->next;
+        --depths[lane];
+        tops[lane] = stack[depths[lane]];
+    }
+    return automaton->isFinal(states[lane]) ? Engine::Outcome::Accepted : Engine::Outcome::NotFinalState;
+}
+
+Engine::Outcome LockstepBatch::continueInEngine(size_t lane)
+{
+    Engine::Snapshot snapshot{states[lane], PdaStack(), Automaton::NoTransition, 0, Engine::Outcome::Running};
+    snapshot.stack.push(stacks.data() + lane * StackStride + 1, depths[lane]);
+
+    Engine engine(*automaton);
+    engine.restore(snapshot);
+    engine.feed(cursors[lane], size_t(ends[lane] - cursors[lane]));
+    return engine.finish();
+}
+
+Engine::Outcome LockstepBatch::reject(size_t lane) const
+{
+    if (!automaton->isKnownState(states[lane])) {
+        return Engine::Outcome::UnknownState;
+    }
+    if (!automaton->isKnownSymbol(symbols[lane])) {
+        return Engine::Outcome::UnknownSymbol;
+    }
+    if (!automaton->isKnownStackSymbol(tops[lane])) {
+        return Engine::Outcome::UnknownStackSymbol;
+    }
+    return Engine::Outcome::NoRule;
+}
@@ -0,0 +1,76 @@
+#ifndef LOCKSTEPBATCH_H
+#define LOCKSTEPBATCH_H
+
+#include "engine.h"
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Проверяет много коротких цепочек одним ДМПА, продвигая до Lanes цепочек одновременно.
+// Состояния, вершины, позиции и стеки дорожек лежат раздельными массивами, так что поиск
+// правил для всех дорожек — один проход по таблице переходов (с AVX2 — сборкой по 8 индексов).
+// Завершившаяся дорожка сразу занимается следующей цепочкой. Цепочки со стеком глубже
+// MaxDepth и застревающие λ-переходы дорабатываются обычным Engine, поэтому исходы
+// совпадают с Engine::run().
+class LockstepBatch
+{
+public:
+    static constexpr size_t Lanes = 64;
+    static constexpr uint32_t MaxDepth = 64;
+    static constexpr uint32_t MaxPush = 4;
+
+    explicit LockstepBatch(const Automaton& automaton);
+    // Копия разделяет таблицу правил с исходным объектом и получает свои дорожки,
+    // так что таблица строится один раз, а копии работают в разных потоках.
+    LockstepBatch(const LockstepBatch&) = default;
+    LockstepBatch& operator=(const LockstepBatch&) = delete;
+
+    void run(const std::u16string_view* inputs, size_t count, Engine::Outcome* outcomes);
+
+private:
+    // Правило в виде для безусловной записи: push дополнен до MaxPush элементов.
+    struct Move
+    {
+        int32_t next;
+        uint16_t pop;
+        uint16_t pushCount;
+        int32_t push[MaxPush];
+    };
+
+    const Automaton* automaton;
+    bool vectorIndex;
+    std::shared_ptr<const std::vector<Move>> moves;
+    // moves->data(), чтобы горячий цикл не разыменовывал shared_ptr.
+    const Move* moveTable = nullptr;
+
+    std::vector<int32_t> states;
+    std::vector<int32_t> tops;
+    std::vector<int32_t> symbols;
+    std::vector<int32_t> rules;
+    std::vector<uint32_t> depths;
+    std::vector<const char16_t*> cursors;
+    std::vector<const char16_t*> ends;
+    std::vector<size_t> owners;
+    // Стек дорожки: элемент 0 — ограничитель -1, символы лежат с 1 по depth, вершина — stack[depth].
+    std::vector<int32_t> stacks;
+
+    const std::u16string_view* inputs = nullptr;
+    Engine::Outcome* outcomes = nullptr;
+    size_t count = 0;
+    size_t next = 0;
+    size_t active = 0;
+
+    bool replace(size_t lane);
+    void load(size_t lane, size_t input);
+    void move(size_t from, size_t to);
+    bool prepare(size_t lane);
+    void lookup();
+    bool apply(size_t lane);
+    Engine::Outcome finish(size_t lane);
+    Engine::Outcome continueInEngine(size_t lane);
+    Engine::Outcome reject(size_t lane) const;
+};
+
+#endif // LOCKSTEPBATCH_H
@@ -1,329 +1,504 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "engine.h"
+#include "configloader.h"
 #include <QFileDialog>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
-#include <QTimer>
+#include <QMessageBox>
+
+#include <algorithm>
+#include <limits>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
+    , model(nullptr)
+    , traceModel(new TraceModel(this))
+    , worker(new SimulationWorker)
 {
     ui->setupUi(this);
     ui->list->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    ui->list->setUniformItemSizes(true);
+    ui->trace->setModel(traceModel);
+    ui->trace->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    ui->trace->hide();
+    ui->statistics->hide();
+    ui->configuration->hide();
     ui->log->hide();
     ui->start->hide();
     ui->slider->hide();
+    ui->stepBack->hide();
+    ui->pause->hide();
+    ui->stepForward->hide();
+    ui->delay->hide();
+    ui->traceLevel->hide();
+    ui->exportTrace->hide();
+
+    worker->moveToThread(&workerThread);
+    connect(&workerThread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(worker, &SimulationWorker::frameReady, this, &MainWindow::showFrame);
+    connect(worker, &SimulationWorker::progress, this, &MainWindow::updateProgress);
+    connect(worker, &SimulationWorker::finished, this, &MainWindow::finishRun);
+    connect(worker, &SimulationWorker::traced, this, &MainWindow::appendTrace);
+    connect(worker, &SimulationWorker::exportProgress, this, &MainWindow::updateExportProgress);
+    connect(worker, &SimulationWorker::exported, this, &MainWindow::finishExport);
+    connect(worker, &SimulationWorker::evaluated, this, &MainWindow::showEvaluation);
+    connect(worker, &SimulationWorker::statistics, this, &MainWindow::showStatistics);
+    connect(ui->command, &QLineEdit::textChanged, this, &MainWindow::requestEvaluation);
+    workerThread.start();
+
+    playback.setSingleShot(true);
+    connect(&playback, &QTimer::timeout, this, &MainWindow::playNext);
 }
 
 MainWindow::~MainWindow()
 {
+    workerThread.quit();
+    workerThread.wait();
     delete ui;
 }
 
-bool MainWindow::parseJsonFile(const QString& filePath)
+bool MainWindow::parseJsonFile(const QString& filePath, QString& error)
 {
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly)) {
-        qWarning() << "Не удалось открыть файл:" << filePath;
+    Automaton loaded;
+    if (!loadAutomaton(filePath, loaded, true, &timings, &error)) {
         return false;
     }
 
-    QByteArray fileData = file.readAll();
-    file.close();
-
-    QJsonParseError parseError;
-    QJsonDocument jsonDoc = QJsonDocument::fromJson(fileData, &parseError);
-    if (parseError.error != QJsonParseError::NoError) {
-        qWarning() << "Ошибка парсинга JSON:" << parseError.errorString();
-        return false;
+    automaton = std::move(loaded);
+    if (!automaton.isDeterministic()) {
+        qWarning() << "Автомат недетерминирован: для каждого ключа используется последнее правило.";
     }
+    return true;
+}
 
-    if (!jsonDoc.isObject()) {
-        qWarning() << "JSON не является объектом!";
-        return false;
+void MainWindow::populateList()
+{
+    if (ui->list->model()) {
+        delete ui->list->model();
     }
+    model = new RuleListModel(automaton, this);
+    ui->list->setModel(model);
+}
 
-    QJsonObject jsonObj = jsonDoc.object();
+void MainWindow::openFields()
+{
+    ui->start->setEnabled(true);
+    ui->loadConfig->setEnabled(true);
+    ui->command->setEnabled(true);
+}
 
-    if (jsonObj.contains("states") && jsonObj["states"].isArray()) {
-        QJsonArray statesArray = jsonObj["states"].toArray();
-        states.clear();
-        for (const QJsonValue &value : statesArray) {
-            if (value.isString()) {
-                states.append(value.toString());
-            }
-        }
-        qDebug() << "States:" << states;
+void MainWindow::setRunControlsEnabled(bool enabled)
+{
+    ui->start->setEnabled(enabled);
+    ui->slider->setEnabled(enabled);
+    ui->stepBack->setEnabled(enabled);
+    ui->pause->setEnabled(enabled);
+    ui->stepForward->setEnabled(enabled);
+    ui->exportTrace->setEnabled(false);
+}
+
+void MainWindow::on_start_clicked()
+{
+    ui->log->clear();
+    if (automaton.isEmpty()){
+        return;
     }
-    else{
-        qDebug() << "Массив 'states' не найден или не является массивом!";
-        return false;
+    ui->start->setEnabled(false);
+    ui->loadConfig->setEnabled(false);
+    ui->command->setEnabled(false);
+    ui->traceLevel->setEnabled(false);
+    ui->exportTrace->setEnabled(false);
+    ui->exportTrace->setText("Сохранить трассу");
+    ui->configuration->clear();
+    traceModel->reset(automaton);
+
+    const quint64 run = ++runId;
+    active = true;
+    finished = false;
+    knownSteps = 0;
+    hasFrame = false;
+    requested = false;
+    highlightRule(-1);
+    model->setRuleHits({});
+    setTimelineMaximum(0);
+
+    const TraceLevel level = TraceLevel(ui->traceLevel->currentIndex());
+    QMetaObject::invokeMethod(worker, [worker = worker, run, automaton = automaton, input = ui->command->text(), level] {
+        worker->start(run, automaton, input, level);
+    });
+    setPlaying(true);
+    requestFrame(0);
+}
+
+void MainWindow::on_pause_clicked()
+{
+    setPlaying(!playing);
+    if (playing) {
+        playNext();
     }
+}
 
-    if (jsonObj.contains("alphabet") && jsonObj["alphabet"].isArray()) {
-        QJsonArray alphabetArray = jsonObj["alphabet"].toArray();
-        alphabet.clear();
-        for (const QJsonValue &value : alphabetArray) {
-            if (value.isString()) {
-                alphabet.append(value.toString());
-            }
-        }
-        if (!alphabet.contains("λ")){
-            alphabet.push_back("λ");
-        }
-        qDebug() << "Alphabet:" << alphabet;
+void MainWindow::on_stepBack_clicked()
+{
+    setPlaying(false);
+    if (hasFrame && shown.step > 0) {
+        requestFrame(shown.step - 1);
     }
-    else{
-        qDebug() << "Массив 'alphabet' не найден или не является массивом!";
-        return false;
+}
+
+void MainWindow::on_stepForward_clicked()
+{
+    setPlaying(false);
+    if (hasFrame && shown.step < knownSteps) {
+        requestFrame(shown.step + 1);
     }
+}
+
+void MainWindow::on_slider_valueChanged(int value)
+{
+    setPlaying(false);
+    requestFrame(quint64(value));
+}
 
-    if (jsonObj.contains("in_stack") && jsonObj["in_stack"].isArray()) {
-        QJsonArray inStackArray = jsonObj["in_stack"].toArray();
-        in_stack.clear();
-        for (const QJsonValue &value : inStackArray) {
-            if (value.isString()) {
-                in_stack.append(value.toString());
-            }
+void MainWindow::playNext()
+{
+    if (!playing || requested || !hasFrame) {
+        return;
+    }
+    if (shown.step >= knownSteps) {
+        // Ждём следующей порции от исполнителя либо останавливаемся в конце прогона.
+        if (finished) {
+            setPlaying(false);
         }
-        qDebug() << "In stack:" << in_stack;
+        return;
     }
-    else{
-        qDebug() << "Массив 'in_stack' не найден или не является массивом!";
-        return false;
+    requestFrame(shown.step + 1);
+}
+
+void MainWindow::requestFrame(quint64 step)
+{
+    target = step;
+    if (!active || requested) {
+        return;
     }
+    requested = true;
+    QMetaObject::invokeMethod(worker, [worker = worker, run = runId, step] {
+        worker->seek(run, step);
+    });
+}
 
-    if (jsonObj.contains("rules") && jsonObj["rules"].isArray()) {
-        QJsonArray rulesArray = jsonObj["rules"].toArray();
-        transitionFunction.clear();
-
-        for (const QJsonValue &value : rulesArray) {
-            if (!value.isArray()) {
-                qDebug() << "Элемент не является массивом!";
-                return false;
-            }
-
-            QJsonArray rule = value.toArray();
-            if (rule.size() != 5) {
-                qDebug() << "Неверный размер массива правила!";
-                return false;
-            }
-            QString key1 = rule[0].toString();
-            QString key2 = rule[1].toString();
-            QString key3 = rule[2].toString();
-            QString value1 = rule[3].toString();
-            QString value2 = rule[4].toString();
-
-            transitionFunction[std::make_tuple(key1, key2, key3)] = std::make_tuple(value1, value2);
-        }
+void MainWindow::setPlaying(bool value)
+{
+    playing = value;
+    if (!playing) {
+        playback.stop();
     }
-    else{
-        qDebug() << "Массив 'rules' не найден или не является массивом!";
-        return false;
+    ui->pause->setText(playing ? "Пауза" : "Продолжить");
+}
+
+void MainWindow::setTimelineMaximum(quint64 steps)
+{
+    const QSignalBlocker blocker(ui->slider);
+    ui->slider->setMaximum(int(std::min<quint64>(steps, std::numeric_limits<int>::max())));
+}
+
+void MainWindow::highlightRule(int rule)
+{
+    if (!model) {
+        return;
+    }
+    const QModelIndex index = model->highlightRule(rule);
+    if (index.isValid()) {
+        ui->list->scrollTo(index);
     }
+}
 
-    if (jsonObj.contains("start") && jsonObj["start"].isString()) {
-        startState = jsonObj["start"].toString();
-        qDebug() << "Start state:" << startState;
+void MainWindow::showFrame(quint64 run, const SimulationFrame& frame)
+{
+    if (run != runId) {
+        return;
     }
-    else{
-        qDebug() << "значение 'start' не найден или не является массивом!";
-        return false;
+    requested = false;
+    if (frame.step != target && target <= knownSteps) {
+        // Пока кадр готовился, пользователь ушёл дальше по шкале.
+        requestFrame(target);
+        return;
     }
 
-    if (jsonObj.contains("start_stack") && jsonObj["start_stack"].isString()) {
-        startStack = jsonObj["start_stack"].toString();
-        qDebug() << "Start stack:" << startStack;
+    ui->configuration->setText("(" + frame.state + ", " + frame.command + ", " + frame.stack + ")");
+    const QModelIndex traced = traceModel->indexOfStep(frame.step);
+    if (traced.isValid()) {
+        ui->trace->setCurrentIndex(traced);
+        ui->trace->scrollTo(traced);
     }
-    else{
-        qDebug() << "значение 'start_stack' не найден или не является массивом!";
-        return false;
+    else {
+        ui->trace->clearSelection();
+    }
+    shown = frame;
+    hasFrame = true;
+    highlightRule(frame.rule);
+    {
+        const QSignalBlocker blocker(ui->slider);
+        ui->slider->setValue(int(std::min<quint64>(frame.step, std::numeric_limits<int>::max())));
     }
 
-    if (jsonObj.contains("ends") && jsonObj["ends"].isArray()) {
-        QJsonArray endsArray = jsonObj["ends"].toArray();
-        endStates.clear();
-        for (const QJsonValue &value : endsArray) {
-            if (value.isString()) {
-                endStates.append(value.toString());
-            }
-        }
-        qDebug() << "End states:" << endStates;
+    if (finished && frame.step == knownSteps) {
+        showVerdict();
+        setPlaying(false);
     }
-    else{
-        qDebug() << "Массив 'rules' не найден или не является массивом!";
-        return false;
+    else if (playing) {
+        playback.start(ui->delay->value());
     }
-    return true;
 }
 
-void MainWindow::populateList()
+void MainWindow::updateProgress(quint64 run, quint64 steps)
 {
-    if (ui->list->model()) {
-        delete ui->list->model();
+    if (run != runId) {
+        return;
     }
-    model = new QStandardItemModel(this);
-
-    QStringList list;
-
-    for (auto it = transitionFunction.begin(); it != transitionFunction.end(); ++it) {
-        auto key = it.key();
-        auto value = it.value();
-
-        QString keyStr = QString("(%1, %2, %3)")
-                             .arg(std::get<0>(key))
-                             .arg(std::get<1>(key))
-                             .arg(std::get<2>(key));
-
-        QString valueStr = QString("(%1, %2)")
-                               .arg(std::get<0>(value))
-                               .arg(std::get<1>(value));
-
-        QStandardItem *item = new QStandardItem(QString("%1 -> %2").arg(keyStr, valueStr));
-
-        model->appendRow(item);
+    knownSteps = steps;
+    setTimelineMaximum(steps);
+    if (playing && !playback.isActive()) {
+        playNext();
     }
-
-    ui->list->setModel(model);
 }
 
-void MainWindow::openFields()
+void MainWindow::finishRun(quint64 run, quint64 steps, int outcome)
 {
-    ui->start->setEnabled(true);
-    ui->loadConfig->setEnabled(true);
-    ui->command->setEnabled(true);
+    if (run != runId) {
+        return;
+    }
+    knownSteps = steps;
+    finished = true;
+    finalOutcome = outcome;
+    setTimelineMaximum(steps);
+    openFields();
+    ui->traceLevel->setEnabled(true);
+    ui->exportTrace->setEnabled(true);
+    if (hasFrame && !requested && shown.step == steps) {
+        showVerdict();
+        setPlaying(false);
+    }
 }
 
-QString printStack(const QStack<QString>& stack){
-    QString result{};
-    for(auto it = stack.rbegin(); it != stack.rend(); ++it){
-        result += *it;
+void MainWindow::appendTrace(quint64 run, const QVector<TraceRecord>& records)
+{
+    if (run == runId) {
+        traceModel->append(records);
     }
-    return result;
 }
 
-void MainWindow::on_start_clicked()
+void MainWindow::on_exportTrace_clicked()
 {
-    ui->start->setEnabled(false);
-    ui->loadConfig->setEnabled(false);
-    ui->command->setEnabled(false);
-    ui->log->clear();
-    QString command = ui->command->text();
-    QString state = startState;
-    QStack<QString> stack;
-    stack.push(startStack);
-    QString newState;
-    QString stackOperation;
-    bool reload = false;
-    while(stack.size() > 0){
-        if(command.isEmpty()) command = "λ";
-        QString string = "<font color='green'>(" + state + ", " + command + ", " + printStack(stack) + ")</font>";
-        ui->log->append(string);
-        if (!states.contains(state)){
-            QString error = "<font color='red'>δ(" + state + "," + command[0] + ", " + stack.top() + ") -> Состояния {" + state + "} не существует!!</font>";
-            ui->log->append(error);
-            openFields();
-            return;
-        }
-        if (!alphabet.contains(QString(command[0]))){
-            QString error = "<font color='red'>δ(" + state + "," + command[0] + ", " + stack.top() + ") -> Символ {" + command[0] + "} не входит в алфавит!</font>";
-            ui->log->append(error);
-            openFields();
-            return;
-        }
-        if (!in_stack.contains(stack.top())){
-            QString error = "<font color='red'>δ(" + state + "," + command[0] + ", " + stack.top() + ") -> Символ {" + stack.top() + "} не входит в алфавит стека!</font>";
-            ui->log->append(error);
-            openFields();
-            return;
-        }
-        QString searchString = QString("(%1, %2, %3)").arg(state, command[0], stack.top());
-
-        int row = 0;
-        QBrush color = model->item(0)->background();
-        QStandardItem *item = model->item(0);
-
-        for (row = 0; row < model->rowCount(); ++row) {
-            item = model->item(row);
-            QString currentText = item->text();
-
-            if (currentText.startsWith(searchString)) {
-                item->setBackground(QBrush(QColor(144, 238, 144)));
-                break;
-            }
-        }
-        if (!transitionFunction.contains(std::make_tuple(state, command[0], stack.top()))){
-            QString error = "<font color='red'>Не существует правила перехода (" + state + "," + command[0] + ", " + stack.top() + "). Цепочка не принадлежит заданному ДМПА!</font>";
-            ui->log->append(error);
-            openFields();
-            return;
-        }
-        QString left = "<font color='green'>δ(" + state + "," + command[0] + "," + stack.top() + ") -> ";
-        std::tie(newState, stackOperation) = transitionFunction[std::make_tuple(state, command[0], stack.top())];
-
-        if (stackOperation.length() > 1){
-            if (QString(stackOperation.back()) == stack.top()){
-                stackOperation.chop(1);
-            }
-            for(auto it = stackOperation.rbegin(); it != stackOperation.rend(); it++){
-                stack.push(QString(*it));
-            }
-        }
-        else{
-            if (stackOperation == "ε")
-            {
-                stack.pop();
-            }
-            else
-            {
-                stack.pop();
-                stack.push(stackOperation);
-            }
-        }
+    const QString fileName = QFileDialog::getSaveFileName(this, "Сохранить трассу", "", "Text Files (*.txt)");
+    if (fileName.isEmpty() || !active) {
+        return;
+    }
+    ui->exportTrace->setEnabled(false);
+    QMetaObject::invokeMethod(worker, [worker = worker, run = runId, fileName] {
+        worker->exportTrace(run, fileName);
+    });
+}
 
-        state = newState;
-
-        command.removeFirst();
-        QString right;
-        if (command.isEmpty()) command = "λ";
-        right = "Новое состояние {" + state + "} оставшаяся цепочка - " + command + "</font>";
-        ui->log->append(left + right);
-        ui->log->append("<font color='green'>Стек (" + printStack(stack) +")");
-        QTime dieTime= QTime::currentTime().addMSecs(ui->slider->value());
-        while (QTime::currentTime() < dieTime)
-            QCoreApplication::processEvents(QEventLoop::AllEvents, 100);
-        item->setBackground(color);
-    }
-    if (command!="λ"){
-        QString error = "<font color='red'>В цепочке остались символы: " + command + ". Цепочка не принадлежит заданному ДМПА!</font>";
-        ui->log->append(error);
-        openFields();
+void MainWindow::updateExportProgress(quint64 run, quint64 steps)
+{
+    if (run != runId || knownSteps == 0) {
         return;
     }
+    ui->exportTrace->setText(QString("Сохранение трассы: %1%").arg(steps * 100 / knownSteps));
+}
 
-    if (!endStates.contains(state)){
-       QString error = "<font color='red'>Cостояние {" + state + "} не является конечным. Цепочка не принадлежит заданному ДМПА!</font>";
-       ui->log->append(error);
-        openFields();
+void MainWindow::finishExport(quint64 run, bool ok)
+{
+    if (run != runId) {
         return;
     }
-    ui->log->append("<font color='green'>Цепочка принадлежит заданному ДМПА!</font>");
-    openFields();
+    ui->exportTrace->setText("Сохранить трассу");
+    ui->exportTrace->setEnabled(true);
+    if (ok) {
+        ui->log->append("<font color='green'>Трасса сохранена.</font>");
+    }
+    else {
+        ui->log->append("<font color='red'>Не удалось сохранить трассу!</font>");
+    }
 }
 
+void MainWindow::showVerdict()
+{
+    const QString& state = shown.state;
+    const QString command = shown.command.left(1);
+    const QString& top = shown.top;
+    switch (Engine::Outcome(finalOutcome)) {
+    case Engine::Outcome::Diverges:
+        ui->log->append("<font color='red'>δ(" + state + "," + command + ", " + top + ") -> Цепочка λ-переходов никогда не завершится. Цепочка не принадлежит заданному ДМПА!</font>");
+        break;
+    case Engine::Outcome::UnknownState:
+        ui->log->append("<font color='red'>δ(" + state + "," + command + ", " + top + ") -> Состояния {" + state + "} не существует!!</font>");
+        break;
+    case Engine::Outcome::UnknownSymbol:
+        ui->log->append("<font color='red'>δ(" + state + "," + command + ", " + top + ") -> Символ {" + command + "} не входит в алфавит!</font>");
+        break;
+    case Engine::Outcome::UnknownStackSymbol:
+        ui->log->append("<font color='red'>δ(" + state + "," + command + ", " + top + ") -> Символ {" + top + "} не входит в алфавит стека!</font>");
+        break;
+    case Engine::Outcome::NoRule:
+        ui->log->append("<font color='red'>Не существует правила перехода (" + state + "," + command + ", " + top + "). Цепочка не принадлежит заданному ДМПА!</font>");
+        break;
+    case Engine::Outcome::InputLeft:
+        ui->log->append("<font color='red'>В цепочке остались символы: " + shown.command + ". Цепочка не принадлежит заданному ДМПА!</font>");
+        break;
+    case Engine::Outcome::NotFinalState:
+        ui->log->append("<font color='red'>Cостояние {" + state + "} не является конечным. Цепочка не принадлежит заданному ДМПА!</font>");
+        break;
+    default:
+        ui->log->append("<font color='green'>Цепочка принадлежит заданному ДМПА!</font>");
+        break;
+    }
+}
 
 void MainWindow::on_loadConfig_clicked()
 {
     QString fileName = QFileDialog::getOpenFileName(this, "Выбрать файл", "", "JSON Files (*.json)");
     if (!fileName.isEmpty()) {
-        parseJsonFile(fileName);
+        // Прогон по старому автомату больше не показывается.
+        ++runId;
+        active = false;
+        requested = false;
+        hasFrame = false;
+        setPlaying(false);
+        setTimelineMaximum(0);
+        QString error;
+        const bool loaded = parseJsonFile(fileName, error);
+        if (!loaded) {
+            // Прежний автомат сбрасывается, чтобы цепочки не проверялись не тем автоматом.
+            automaton = Automaton();
+        }
         populateList();
+        traceModel->reset(automaton);
+        ui->verdict->clear();
+        ui->configuration->clear();
+        ui->statistics->clear();
+        QMetaObject::invokeMethod(worker, [worker = worker, automaton = automaton] {
+            worker->setAutomaton(automaton);
+        });
+        setRunControlsEnabled(loaded);
+        if (!loaded) {
+            QMessageBox::warning(this, "Ошибка загрузки", error);
+            return;
+        }
+
         ui->log->show();
         ui->log->clear();
         ui->start->show();
         ui->slider->show();
+        ui->stepBack->show();
+        ui->pause->show();
+        ui->stepForward->show();
+        ui->delay->show();
+        ui->traceLevel->show();
+        ui->exportTrace->show();
+        ui->trace->show();
+        ui->configuration->show();
+        ui->statistics->show();
+        ui->statistics->setPlainText(QString("Загрузка: %1 мс\nКомпиляция: %2 мс")
+                                         .arg(timings.loadSeconds * 1e3, 0, 'f', 1)
+                                         .arg(timings.compileSeconds * 1e3, 0, 'f', 1));
+        requestEvaluation();
     }
 }
 
+void MainWindow::requestEvaluation()
+{
+    if (automaton.isEmpty()) {
+        return;
+    }
+    // Одновременно проверяется одна цепочка; правки, сделанные за это время, проверяются следом.
+    if (evaluating) {
+        evaluationDirty = true;
+        return;
+    }
+    evaluating = true;
+    evaluationDirty = false;
+    QMetaObject::invokeMethod(worker, [worker = worker, request = ++evaluationId, input = ui->command->text()] {
+        worker->evaluate(request, input);
+    });
+}
+
+void MainWindow::showEvaluation(quint64 request, int outcome)
+{
+    if (request != evaluationId) {
+        return;
+    }
+    evaluating = false;
+    if (evaluationDirty) {
+        requestEvaluation();
+        return;
+    }
+
+    switch (Engine::Outcome(outcome)) {
+    case Engine::Outcome::Running:
+        ui->verdict->clear();
+        break;
+    case Engine::Outcome::Accepted:
+        ui->verdict->setText("<font color='green'>Цепочка принадлежит заданному ДМПА</font>");
+        break;
+    case Engine::Outcome::UnknownState:
+        ui->verdict->setText("<font color='red'>Не принадлежит: переход в несуществующее состояние</font>");
+        break;
+    case Engine::Outcome::UnknownSymbol:
+        ui->verdict->setText("<font color='red'>Не принадлежит: символ не входит в алфавит</font>");
+        break;
+    case Engine::Outcome::UnknownStackSymbol:
+        ui->verdict->setText("<font color='red'>Не принадлежит: символ не входит в алфавит стека</font>");
+        break;
+    case Engine::Outcome::NoRule:
+        ui->verdict->setText("<font color='red'>Не принадлежит: нет правила перехода</font>");
+        break;
+    case Engine::Outcome::InputLeft:
+        ui->verdict->setText("<font color='red'>Не принадлежит: стек пуст, а в цепочке остались символы</font>");
+        break;
+    case Engine::Outcome::NotFinalState:
+        ui->verdict->setText("<font color='red'>Не принадлежит: состояние не является конечным</font>");
+        break;
+    case Engine::Outcome::Diverges:
+        ui->verdict->setText("<font color='red'>Не принадлежит: цепочка λ-переходов никогда не завершится</font>");
+        break;
+    }
+}
+
+
+void MainWindow::showStatistics(quint64 run, const RunStatistics& statistics)
+{
+    if (run != runId || !model) {
+        return;
+    }
+    model->setRuleHits(statistics.ruleHits);
+
+    const int32_t unused = int32_t(std::count(statistics.ruleHits.begin(), statistics.ruleHits.end(), uint64_t(0)));
+    QString text = QString("Загрузка: %1 мс\nКомпиляция: %2 мс\nВыполнение: %3 мс\n")
+                       .arg(timings.loadSeconds * 1e3, 0, 'f', 1)
+                       .arg(timings.compileSeconds * 1e3, 0, 'f', 1)
+                       .arg(statistics.runSeconds * 1e3, 0, 'f', 1);
+    if (statistics.steps() > 0 && statistics.runSeconds > 0) {
+        text += QString("Среднее время шага: %1 нс\n").arg(statistics.runSeconds * 1e9 / double(statistics.steps()), 0, 'f', 1);
+    }
+    text += QString("\nПереходов по входу: %1\nλ-переходов: %2\nШагов на символ: %3\n"
+                    "Правил без срабатываний: %4 из %5\n")
+                .arg(statistics.inputMoves)
+                .arg(statistics.lambdaMoves)
+                .arg(statistics.stepsPerSymbol(), 0, 'f', 2)
+                .arg(unused)
+                .arg(statistics.ruleHits.size());
+    text += QString("\nГлубина стека: наибольшая %1, средняя %2\n")
+                .arg(statistics.maxDepth)
+                .arg(statistics.meanDepth(), 0, 'f', 1);
+    for (int bucket = 0; bucket < RunStatistics::DepthBuckets; ++bucket) {
+        if (statistics.depthHistogram[bucket] == 0) {
+            continue;
+        }
+        const quint64 from = bucket == 0 ? 0 : quint64(1) << (bucket - 1);
+        const quint64 to = bucket == 0 ? 0 : from * 2 - 1;
+        text += QString("  %1–%2: %3\n").arg(from).arg(to).arg(statistics.depthHistogram[bucket]);
+    }
+    ui->statistics->setPlainText(text);
+}
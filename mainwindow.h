@@ -2,8 +2,14 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include <QStandardItemModel>
-#include <QStack>
+#include <QThread>
+#include <QTimer>
+
+#include "automaton.h"
+#include "configloader.h"
+#include "rulelistmodel.h"
+#include "simulationworker.h"
+#include "tracemodel.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -24,19 +30,59 @@ private slots:
 
     void on_loadConfig_clicked();
 
+    void on_pause_clicked();
+
+    void on_stepBack_clicked();
+
+    void on_stepForward_clicked();
+
+    void on_slider_valueChanged(int value);
+
+    void on_exportTrace_clicked();
+
+    void playNext();
+    void showFrame(quint64 run, const SimulationFrame& frame);
+    void updateProgress(quint64 run, quint64 steps);
+    void finishRun(quint64 run, quint64 steps, int outcome);
+    void appendTrace(quint64 run, const QVector<TraceRecord>& records);
+    void updateExportProgress(quint64 run, quint64 steps);
+    void finishExport(quint64 run, bool ok);
+    void requestEvaluation();
+    void showEvaluation(quint64 request, int outcome);
+    void showStatistics(quint64 run, const RunStatistics& statistics);
+
 private:
     Ui::MainWindow *ui;
-    QStringList states;
-    QStringList alphabet;
-    QStringList in_stack;
-    QMap<std::tuple<QString, QString, QString>, std::tuple<QString, QString>> transitionFunction;
-    QString startState;
-    QString startStack;
-    QStringList endStates;
-    QStandardItemModel *model;
-
-    bool parseJsonFile(const QString& filePath);
+    RuleListModel *model;
+    TraceModel *traceModel;
+    Automaton automaton;
+    LoadTimings timings;
+
+    QThread workerThread;
+    SimulationWorker *worker;
+    QTimer playback;
+    quint64 runId = 0;
+    bool active = false;
+    bool playing = false;
+    bool requested = false;
+    bool finished = false;
+    quint64 knownSteps = 0;
+    quint64 target = 0;
+    int finalOutcome = 0;
+    bool hasFrame = false;
+    SimulationFrame shown;
+    quint64 evaluationId = 0;
+    bool evaluating = false;
+    bool evaluationDirty = false;
+
+    bool parseJsonFile(const QString& filePath, QString& error);
     void populateList();
     void openFields();
+    void setRunControlsEnabled(bool enabled);
+    void requestFrame(quint64 step);
+    void setPlaying(bool value);
+    void setTimelineMaximum(quint64 steps);
+    void highlightRule(int rule);
+    void showVerdict();
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,294 @@
+#include "nondeterministicsearch.h"
+#include "workstealingpool.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+const size_t SplitThreshold = 256;
+// clear() у unordered_map/set проходит по всем корзинам, а их число не уменьшается. Шард, разросшийся
+// на длинной цепочке, заменяется новым, иначе каждый следующий запуск платил бы за его корзины.
+const size_t MaxReusedBuckets = 128;
+
+uint64_t mix(uint64_t value)
+{
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdull;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ull;
+    value ^= value >> 33;
+    return value;
+}
+
+}
+
+struct NondeterministicSearch::Configuration
+{
+    int32_t state;
+    uint32_t stack;
+    uint64_t position;
+
+    bool operator==(const Configuration& other) const
+    {
+        return state == other.state && stack == other.stack && position == other.position;
+    }
+
+    uint64_t hash() const { return mix(position * 0x9e3779b97f4a7c15ull ^ (uint64_t(uint32_t(state)) << 32 | stack)); }
+};
+
+// Лес стеков: узел хранит символ на вершине и номер стека под ним, 0 — пустой стек.
+// Номер узла кодирует шард и позицию в нём; узлы лежат в блоках, которые не
+// перемещаются, поэтому читать уже выданные узлы можно без блокировки.
+class NondeterministicSearch::StackStore
+{
+public:
+    static constexpr uint32_t Empty = 0;
+
+    struct Node
+    {
+        int32_t symbol;
+        uint32_t parent;
+    };
+
+    StackStore()
+    {
+        for (auto& shard : shards) {
+            shard.chunks.resize(MaxChunks);
+        }
+    }
+
+    void clear()
+    {
+        for (auto& shard : shards) {
+            if (shard.index.bucket_count() > MaxReusedBuckets) {
+                std::unordered_map<uint64_t, uint32_t>().swap(shard.index);
+            }
+            else {
+                shard.index.clear();
+            }
+            shard.count = 0;
+        }
+    }
+
+    // Возвращает false, если место под узлы исчерпано.
+    bool push(uint32_t parent, int32_t symbol, uint32_t& id)
+    {
+        const uint64_t key = uint64_t(uint32_t(symbol)) << 32 | parent;
+        const uint32_t shardIndex = uint32_t(mix(key)) & (Shards - 1);
+        Shard& shard = shards[shardIndex];
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            id = it->second;
+            return true;
+        }
+        if (shard.count == uint32_t(MaxChunks) * ChunkSize) {
+            return false;
+        }
+        auto& chunk = shard.chunks[shard.count >> ChunkBits];
+        if (!chunk) {
+            chunk = std::make_unique<Node[]>(ChunkSize);
+        }
+        chunk[shard.count & (ChunkSize - 1)] = {symbol, parent};
+        id = ((shard.count << ShardBits) | shardIndex) + 1;
+        ++shard.count;
+        shard.index.emplace(key, id);
+        return true;
+    }
+
+    const Node& node(uint32_t id) const
+    {
+        const uint32_t value = id - 1;
+        const Shard& shard = shards[value & (Shards - 1)];
+        const uint32_t local = value >> ShardBits;
+        return shard.chunks[local >> ChunkBits][local & (ChunkSize - 1)];
+    }
+
+    uint64_t size() const
+    {
+        uint64_t total = 0;
+        for (const auto& shard : shards) {
+            total += shard.count;
+        }
+        return total;
+    }
+
+private:
+    static constexpr uint32_t ShardBits = 4;
+    static constexpr uint32_t Shards = 1u << ShardBits;
+    static constexpr uint32_t ChunkBits = 14;
+    static constexpr uint32_t ChunkSize = 1u << ChunkBits;
+    // Номер узла, сдвинутый на +1, должен помещаться в 32 бита.
+    static constexpr uint32_t MaxChunks = (1u << (32 - ShardBits - ChunkBits)) - 1;
+
+    struct Shard
+    {
+        std::mutex mutex;
+        std::unordered_map<uint64_t, uint32_t> index;
+        std::vector<std::unique_ptr<Node[]>> chunks;
+        uint32_t count = 0;
+    };
+
+    Shard shards[Shards];
+};
+
+class NondeterministicSearch::VisitedSet
+{
+public:
+    void clear()
+    {
+        for (auto& shard : shards) {
+            if (shard.configurations.bucket_count() > MaxReusedBuckets) {
+                std::unordered_set<Configuration, Hash>().swap(shard.configurations);
+            }
+            else {
+                shard.configurations.clear();
+            }
+        }
+    }
+
+    bool insert(const Configuration& configuration)
+    {
+        const uint64_t hash = configuration.hash();
+        Shard& shard = shards[hash & (Shards - 1)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.configurations.insert(configuration).second;
+    }
+
+private:
+    static constexpr uint32_t Shards = 64;
+
+    struct Hash
+    {
+        size_t operator()(const Configuration& configuration) const { return size_t(configuration.hash() >> 6); }
+    };
+
+    struct Shard
+    {
+        std::mutex mutex;
+        std::unordered_set<Configuration, Hash> configurations;
+    };
+
+    Shard shards[Shards];
+};
+
+NondeterministicSearch::NondeterministicSearch(const Automaton& automaton, uint64_t configurationLimit)
+    : automaton(automaton)
+    , limit(configurationLimit)
+    , stacks(std::make_unique<StackStore>())
+    , visited(std::make_unique<VisitedSet>())
+{
+}
+
+NondeterministicSearch::~NondeterministicSearch() = default;
+
+uint64_t NondeterministicSearch::stackNodes() const
+{
+    return stacks->size();
+}
+
+NondeterministicSearch::Result NondeterministicSearch::run(std::u16string_view input, WorkStealingPool* pool)
+{
+    stacks->clear();
+    visited->clear();
+    accepted = false;
+    exceeded = false;
+    configurationCount = 0;
+    this->pool = pool;
+
+    symbols.resize(input.size());
+    for (size_t i = 0; i < input.size(); ++i) {
+        symbols[i] = automaton.inputSymbol(input[i]);
+    }
+
+    uint32_t stack = StackStore::Empty;
+    stacks->push(stack, automaton.startStackSymbol(), stack);
+    const Configuration start{automaton.startState(), stack, 0};
+    visited->insert(start);
+    configurationCount = 1;
+
+    if (pool) {
+        pendingTasks = 0;
+        spawn({start});
+        std::unique_lock<std::mutex> lock(doneMutex);
+        done.wait(lock, [this] { return pendingTasks.load() == 0; });
+    }
+    else {
+        explore({start});
+    }
+
+    if (accepted) {
+        return Result::Accepted;
+    }
+    return exceeded ? Result::LimitExceeded : Result::Rejected;
+}
+
+void NondeterministicSearch::spawn(std::vector<Configuration> work)
+{
+    pendingTasks.fetch_add(1);
+    pool->submit([this, work = std::move(work)]() mutable {
+        explore(std::move(work));
+        finishTask();
+    });
+}
+
+void NondeterministicSearch::finishTask()
+{
+    if (pendingTasks.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(doneMutex);
+        done.notify_all();
+    }
+}
+
+void NondeterministicSearch::explore(std::vector<Configuration> work)
+{
+    const uint64_t length = symbols.size();
+
+    while (!work.empty() && !stopped()) {
+        if (pool && work.size() > SplitThreshold) {
+            std::vector<Configuration> half(work.begin(), work.begin() + work.size() / 2);
+            work.erase(work.begin(), work.begin() + work.size() / 2);
+            spawn(std::move(half));
+        }
+
+        const Configuration current = work.back();
+        work.pop_back();
+
+        if (current.stack == StackStore::Empty) {
+            if (current.position == length && automaton.isFinal(current.state)) {
+                accepted = true;
+            }
+            continue;
+        }
+
+        const StackStore::Node top = stacks->node(current.stack);
+        const bool reading = current.position < length;
+        const int32_t symbol = reading ? symbols[current.position] : automaton.lambda();
+        const uint64_t position = reading ? current.position + 1 : current.position;
+
+        for (int32_t index = automaton.transition(current.state, symbol, top.symbol);
+             index != Automaton::NoTransition;
+             index = automaton.alternative(index)) {
+            const Automaton::Rule& rule = automaton.rule(index);
+            uint32_t stack = rule.pop ? top.parent : current.stack;
+            const int32_t* push = automaton.pushSequence(rule);
+            for (uint32_t i = 0; i < rule.pushCount; ++i) {
+                if (!stacks->push(stack, push[i], stack)) {
+                    exceeded = true;
+                    return;
+                }
+            }
+
+            const Configuration next{rule.next, stack, position};
+            if (visited->insert(next)) {
+                if (configurationCount.fetch_add(1) + 1 > limit) {
+                    exceeded = true;
+                    return;
+                }
+                work.push_back(next);
+            }
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef NONDETERMINISTICSEARCH_H
+#define NONDETERMINISTICSEARCH_H
+
+#include "automaton.h"
+
+#include <atomic>
+#include <memory>
+#include <condition_variable>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+class WorkStealingPool;
+
+// Проверка цепочки недетерминированным МПА: каждому ключу (состояние, символ, вершина)
+// соответствует множество правил, и цепочка принимается, если хотя бы одна ветвь
+// вычисления опустошает стек в конечном состоянии после чтения всей цепочки.
+//
+// Граф конфигураций обходится параллельно. Стеки хранятся как общий лес узлов
+// (символ, родитель) с хеш-консингом, поэтому общие нижние части стеков хранятся
+// один раз, а одинаковые стеки имеют один номер. Повторы конфигураций
+// (состояние, позиция, стек) отбрасываются по хешу.
+class NondeterministicSearch
+{
+public:
+    enum class Result {
+        Accepted,
+        Rejected,
+        LimitExceeded
+    };
+
+    explicit NondeterministicSearch(const Automaton& automaton, uint64_t configurationLimit = 10000000);
+    ~NondeterministicSearch();
+
+    NondeterministicSearch(const NondeterministicSearch&) = delete;
+    NondeterministicSearch& operator=(const NondeterministicSearch&) = delete;
+
+    // Без пула обход идёт в вызывающем потоке. Вызывающий поток не должен быть потоком пула.
+    Result run(std::u16string_view input, WorkStealingPool* pool = nullptr);
+
+    uint64_t configurations() const { return configurationCount.load(); }
+    uint64_t stackNodes() const;
+
+private:
+    struct Configuration;
+    class StackStore;
+    class VisitedSet;
+
+    const Automaton& automaton;
+    const uint64_t limit;
+    std::unique_ptr<StackStore> stacks;
+    std::unique_ptr<VisitedSet> visited;
+    std::vector<int32_t> symbols;
+    WorkStealingPool* pool = nullptr;
+
+    std::atomic<bool> accepted{false};
+    std::atomic<bool> exceeded{false};
+    std::atomic<uint64_t> configurationCount{0};
+    std::atomic<size_t> pendingTasks{0};
+    std::mutex doneMutex;
+    std::condition_variable done;
+
+    bool stopped() const { return accepted.load(std::memory_order_relaxed) || exceeded.load(std::memory_order_relaxed); }
+    void explore(std::vector<Configuration> work);
+    void spawn(std::vector<Configuration> work);
+    void finishTask();
+};
+
+#endif // NONDETERMINISTICSEARCH_H
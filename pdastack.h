@@ -0,0 +1,104 @@
+#ifndef PDASTACK_H
+#define PDASTACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Стек магазинного автомата из целых номеров символов.
+// Одиночный символ занимает одну ячейку, как в обычном std::vector<int32_t>. Серия из двух и более
+// одинаковых символов — две ячейки: символ и следом длина с установленным старшим битом (RunTag),
+// поэтому стеки вида aaaa...aZ занимают несколько байт независимо от глубины.
+class PdaStack
+{
+public:
+    bool empty() const { return cells.empty(); }
+    uint64_t size() const { return depth; }
+    int32_t top() const { return int32_t(cells.back() & RunTag ? cells[cells.size() - 2] : cells.back()); }
+
+    // Число занятых ячеек по 4 байта: по нему считается память, занятая снимками.
+    size_t cellCount() const { return cells.size(); }
+
+    void clear()
+    {
+        cells.clear();
+        depth = 0;
+    }
+
+    void push(int32_t symbol)
+    {
+        ++depth;
+        if (!cells.empty()) {
+            uint32_t& last = cells.back();
+            if (last & RunTag) {
+                if (cells[cells.size() - 2] == uint32_t(symbol) && last != MaxRunCell) {
+                    ++last;
+                    return;
+                }
+            }
+            else if (last == uint32_t(symbol)) {
+                cells.push_back(RunTag | 2);
+                return;
+            }
+        }
+        cells.push_back(uint32_t(symbol));
+    }
+
+    // Кладёт symbols[0], ..., symbols[count - 1]; последний оказывается на вершине.
+    void push(const int32_t* symbols, uint32_t count)
+    {
+        for (uint32_t i = 0; i < count; ++i) {
+            push(symbols[i]);
+        }
+    }
+
+    void pop()
+    {
+        uint32_t& last = cells.back();
+        if (!(last & RunTag) || --last == (RunTag | 1)) {
+            cells.pop_back();
+        }
+        --depth;
+    }
+
+    // Обходит серии от вершины ко дну: function(символ, длина) возвращает false, чтобы остановиться.
+    template<typename Function>
+    void forEachRunFromTop(Function function) const
+    {
+        for (size_t i = cells.size(); i > 0;) {
+            const uint32_t cell = cells[--i];
+            uint32_t count = 1;
+            uint32_t symbol = cell;
+            if (cell & RunTag) {
+                count = cell & ~RunTag;
+                symbol = cells[--i];
+            }
+            if (!function(int32_t(symbol), count)) {
+                return;
+            }
+        }
+    }
+
+    template<typename Function>
+    void forEachFromTop(Function function) const
+    {
+        forEachRunFromTop([&function](int32_t symbol, uint32_t count) {
+            for (uint32_t i = 0; i < count; ++i) {
+                function(symbol);
+            }
+            return true;
+        });
+    }
+
+    bool operator==(const PdaStack& other) const { return depth == other.depth && cells == other.cells; }
+    bool operator!=(const PdaStack& other) const { return !(*this == other); }
+
+private:
+    static constexpr uint32_t RunTag = uint32_t(1) << 31;
+    static constexpr uint32_t MaxRunCell = ~uint32_t(0);
+
+    std::vector<uint32_t> cells;
+    uint64_t depth = 0;
+};
+
+#endif // PDASTACK_H
@@ -0,0 +1,109 @@
+#include "recognizercheck.h"
+#include "engine.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QTemporaryDir>
+
+#include <cstdio>
+
+namespace {
+
+const char* const OutcomeNames[] = {"Running", "Accepted", "UnknownState", "UnknownSymbol", "UnknownStackSymbol",
+                                    "NoRule", "InputLeft", "NotFinalState", "Diverges"};
+
+bool writeFile(const QString& filePath, const QByteArray& data)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Не удалось открыть файл:" << filePath;
+        return false;
+    }
+    return file.write(data) == data.size();
+}
+
+}
+
+QString defaultCompiler()
+{
+    return QProcessEnvironment::systemEnvironment().value("CXX", "c++");
+}
+
+bool buildRecognizer(const QByteArray& source, const QString& programPath, const QString& compiler)
+{
+    const QString sourcePath = programPath + ".cpp";
+    if (!writeFile(sourcePath, source)) {
+        return false;
+    }
+
+    QProcess build;
+    build.setProcessChannelMode(QProcess::ForwardedChannels);
+    build.start(compiler, {"-std=c++17", "-O2", "-DPDA_RECOGNIZER_MAIN", sourcePath, "-o", programPath});
+    if (!build.waitForFinished(-1) || build.exitStatus() != QProcess::NormalExit || build.exitCode() != 0) {
+        qWarning() << "Не удалось собрать распознаватель компилятором" << compiler;
+        return false;
+    }
+    return true;
+}
+
+bool runRecognizer(const QString& programPath, const QString& inputsPath, QByteArray& output)
+{
+    QProcess run;
+    run.setStandardInputFile(inputsPath);
+    run.start(programPath, {});
+    if (!run.waitForFinished(-1) || run.exitStatus() != QProcess::NormalExit || run.exitCode() != 0) {
+        qWarning() << "Распознаватель завершился с ошибкой";
+        return false;
+    }
+    output = run.readAllStandardOutput();
+    return true;
+}
+
+bool verifyRecognizer(const Automaton& automaton, const QByteArray& source, const QString& inputsPath,
+                      const QString& compiler)
+{
+    QFile inputFile(inputsPath);
+    if (!inputFile.open(QIODevice::ReadOnly)) {
+        qWarning() << "Не удалось открыть файл:" << inputsPath;
+        return false;
+    }
+    const QList<QByteArray> lines = inputFile.readAll().split('\n');
+    inputFile.close();
+
+    QTemporaryDir dir;
+    const QString programPath = dir.filePath("recognizer");
+    QByteArray output;
+    if (!dir.isValid() || !buildRecognizer(source, programPath, compiler)
+        || !runRecognizer(programPath, inputsPath, output)) {
+        return false;
+    }
+    const QList<QByteArray> results = output.split('\n');
+
+    Engine engine(automaton);
+    qsizetype checked = 0;
+    qsizetype mismatches = 0;
+    for (qsizetype i = 0; i < lines.size(); ++i) {
+        QByteArray line = lines[i];
+        if (i == lines.size() - 1 && line.isEmpty()) {
+            break;
+        }
+        if (line.endsWith('\r')) {
+            line.chop(1);
+        }
+        const QString input = QString::fromUtf8(line);
+        const char* expected = OutcomeNames[int(engine.run(input.toStdU16String()))];
+        const QByteArray actual = i < results.size() ? results[i] : QByteArray();
+        ++checked;
+        if (actual != expected) {
+            if (++mismatches <= 10) {
+                std::fprintf(stderr, "строка %lld: интерпретатор %s, распознаватель %s\n",
+                             static_cast<long long>(i + 1), expected, actual.constData());
+            }
+        }
+    }
+    std::fprintf(stderr, "проверено %lld строк, расхождений %lld\n",
+                 static_cast<long long>(checked), static_cast<long long>(mismatches));
+    return mismatches == 0;
+}
@@ -0,0 +1,24 @@
+#ifndef RECOGNIZERCHECK_H
+#define RECOGNIZERCHECK_H
+
+#include <QByteArray>
+#include <QString>
+
+#include "automaton.h"
+
+// Компилятор C++ по умолчанию: $CXX или c++.
+QString defaultCompiler();
+
+// Собирает распознаватель source с main() (PDA_RECOGNIZER_MAIN) в программу programPath.
+// Исходный текст кладётся рядом, в programPath + ".cpp". Флаги одни для проверки и machine-bench.
+bool buildRecognizer(const QByteArray& source, const QString& programPath, const QString& compiler);
+
+// Запускает собранный распознаватель на строках inputsPath; output — его stdout, по исходу на строку.
+bool runRecognizer(const QString& programPath, const QString& inputsPath, QByteArray& output);
+
+// Собирает распознаватель source системным компилятором, прогоняет на нём все строки
+// inputsPath и сравнивает исходы с интерпретатором Engine. Расхождения печатаются в stderr.
+bool verifyRecognizer(const Automaton& automaton, const QByteArray& source, const QString& inputsPath,
+                      const QString& compiler);
+
+#endif // RECOGNIZERCHECK_H
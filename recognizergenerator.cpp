@@ -0,0 +1,300 @@
+#include "recognizergenerator.h"
+
+#include <sstream>
+
+namespace {
+
+std::string toUtf8(std::u16string_view text)
+{
+    std::string result;
+    for (size_t i = 0; i < text.size(); ++i) {
+        uint32_t c = text[i];
+        if (c >= 0xd800 && c < 0xdc00 && i + 1 < text.size() && text[i + 1] >= 0xdc00 && text[i + 1] < 0xe000) {
+            c = 0x10000 + ((c - 0xd800) << 10) + (text[i + 1] - 0xdc00);
+            ++i;
+        }
+        if (c < 0x80) {
+            result += char(c);
+        }
+        else if (c < 0x800) {
+            result += char(0xc0 | c >> 6);
+            result += char(0x80 | (c & 0x3f));
+        }
+        else if (c < 0x10000) {
+            result += char(0xe0 | c >> 12);
+            result += char(0x80 | (c >> 6 & 0x3f));
+            result += char(0x80 | (c & 0x3f));
+        }
+        else {
+            result += char(0xf0 | c >> 18);
+            result += char(0x80 | (c >> 12 & 0x3f));
+            result += char(0x80 | (c >> 6 & 0x3f));
+            result += char(0x80 | (c & 0x3f));
+        }
+    }
+    return result;
+}
+
+// Имя для однострочного комментария в сгенерированном коде.
+std::string comment(std::u16string_view name)
+{
+    std::string text = toUtf8(name);
+    for (char& c : text) {
+        if (c == '\n' || c == '\r' || c == '\\') {
+            c = ' ';
+        }
+    }
+    return text;
+}
+
+const char* Preamble = R"(#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace %s {
+
+enum class Outcome {
+    Accepted,
+    UnknownState,
+    UnknownSymbol,
+    UnknownStackSymbol,
+    NoRule,
+    InputLeft,
+    NotFinalState,
+    Diverges
+};
+
+)";
+
+const char* Main = R"(
+#ifdef PDA_RECOGNIZER_MAIN
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+static std::u16string decodeUtf8(const std::string& line)
+{
+    std::u16string result;
+    for (size_t i = 0; i < line.size();) {
+        const unsigned char c = static_cast<unsigned char>(line[i]);
+        const int length = c < 0x80 ? 1 : (c >> 5) == 0x6 ? 2 : (c >> 4) == 0xe ? 3 : (c >> 3) == 0x1e ? 4 : 0;
+        uint32_t code = length == 1 ? c : length == 2 ? c & 0x1f : length == 3 ? c & 0x0f : c & 0x07;
+        bool valid = length > 0 && i + length <= line.size();
+        for (int k = 1; valid && k < length; ++k) {
+            const unsigned char next = static_cast<unsigned char>(line[i + k]);
+            valid = (next >> 6) == 0x2;
+            code = code << 6 | (next & 0x3f);
+        }
+        if (!valid) {
+            result += char16_t(0xfffd);
+            ++i;
+            continue;
+        }
+        if (code >= 0x10000) {
+            code -= 0x10000;
+            result += char16_t(0xd800 + (code >> 10));
+            result += char16_t(0xdc00 + (code & 0x3ff));
+        }
+        else {
+            result += char16_t(code);
+        }
+        i += size_t(length);
+    }
+    return result;
+}
+
+int main()
+{
+    static const char* const names[] = {"Accepted", "UnknownState", "UnknownSymbol", "UnknownStackSymbol",
+                                        "NoRule", "InputLeft", "NotFinalState", "Diverges"};
+    std::ios::sync_with_stdio(false);
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        const std::u16string input = decodeUtf8(line);
+        std::fputs(names[int(%s::recognize(input.data(), input.size()))], stdout);
+        std::fputc('\n', stdout);
+    }
+    return 0;
+}
+#endif
+)";
+
+std::string format(const char* pattern, const std::string& value)
+{
+    std::string text(pattern);
+    const size_t at = text.find("%s");
+    return text.replace(at, 2, value);
+}
+
+}
+
+bool isIdentifier(const std::string& name)
+{
+    static const char* const Keywords[] = {
+        "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break", "case",
+        "catch", "char", "char16_t", "char32_t", "class", "compl", "const", "const_cast", "constexpr",
+        "continue", "decltype", "default", "delete", "do", "double", "dynamic_cast", "else", "enum",
+        "explicit", "export", "extern", "false", "float", "for", "friend", "goto", "if", "inline", "int",
+        "long", "mutable", "namespace", "new", "noexcept", "not", "not_eq", "nullptr", "operator", "or",
+        "or_eq", "private", "protected", "public", "register", "reinterpret_cast", "return", "short",
+        "signed", "sizeof", "static", "static_assert", "static_cast", "struct", "switch", "template", "this",
+        "thread_local", "throw", "true", "try", "typedef", "typeid", "typename", "union", "unsigned",
+        "using", "virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq"};
+
+    if (name.empty() || (name[0] >= '0' && name[0] <= '9')) {
+        return false;
+    }
+    for (char c : name) {
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_')) {
+            return false;
+        }
+    }
+    for (const char* keyword : Keywords) {
+        if (name == keyword) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string generateRecognizer(const Automaton& automaton, const std::string& space)
+{
+    std::ostringstream out;
+    out << "// Сгенерировано machine-codegen, не редактировать.\n";
+    out << "// Контрольная сумма исходной конфигурации: " << automaton.sourceChecksum() << "\n\n";
+    out << format(Preamble, space);
+
+    const int32_t knownStates = automaton.knownStateCount();
+    const int32_t knownSymbols = automaton.knownSymbolCount();
+    const int32_t knownStack = automaton.knownStackSymbolCount();
+
+    out << "namespace {\n\n";
+    out << "constexpr int32_t KnownStates = " << knownStates << ";\n";
+    out << "constexpr int32_t KnownSymbols = " << knownSymbols << ";\n";
+    out << "constexpr int32_t KnownStackSymbols = " << knownStack << ";\n";
+    out << "constexpr int32_t Lambda = " << automaton.lambda() << ";\n\n";
+
+    out << "inline int32_t inputSymbol(char16_t c)\n{\n    switch (c) {\n";
+    for (uint32_t c = 0; c <= 0xffff; ++c) {
+        const int32_t symbol = automaton.inputSymbol(char16_t(c));
+        if (symbol != Automaton::UnknownSymbol) {
+            out << "    case 0x" << std::hex << c << std::dec << ": return " << symbol
+                << "; // " << comment(automaton.symbolName(symbol)) << "\n";
+        }
+    }
+    out << "    default: return -1;\n    }\n}\n\n";
+
+    std::ostringstream finals;
+    for (int32_t state = 0; state < automaton.stateCount(); ++state) {
+        if (automaton.isFinal(state)) {
+            finals << "    case " << state << ": // " << comment(automaton.stateName(state)) << "\n";
+        }
+    }
+    out << "inline bool isFinal(int32_t state)\n{\n";
+    if (finals.str().empty()) {
+        out << "    (void)state;\n    return false;\n}\n\n";
+    }
+    else {
+        out << "    switch (state) {\n" << finals.str()
+            << "        return true;\n    default:\n        return false;\n    }\n}\n\n";
+    }
+
+    // Достаточно пар, из которых λ-переходы не завершаются: остальные цепочки
+    // исполняются по шагам и заканчиваются сами.
+    out << "inline bool lambdaDiverges(int32_t state, int32_t top)\n{\n";
+    bool diverges = false;
+    for (int32_t state = 0; state < knownStates; ++state) {
+        for (int32_t top = 0; top < knownStack; ++top) {
+            const Automaton::LambdaSummary* summary = automaton.lambdaSummary(state, top);
+            if (summary && summary->kind == Automaton::LambdaSummary::Diverges) {
+                out << "    if (state == " << state << " && top == " << top << ") return true;\n";
+                diverges = true;
+            }
+        }
+    }
+    if (!diverges) {
+        out << "    (void)state;\n    (void)top;\n";
+    }
+    out << "    return false;\n}\n\n";
+
+    out << "inline Outcome reject(int32_t state, int32_t symbol, int32_t top)\n{\n"
+           "    if (state >= KnownStates) return Outcome::UnknownState;\n"
+           "    if (symbol < 0 || symbol >= KnownSymbols) return Outcome::UnknownSymbol;\n"
+           "    if (top >= KnownStackSymbols) return Outcome::UnknownStackSymbol;\n"
+           "    return Outcome::NoRule;\n}\n\n";
+    out << "}\n\n";
+
+    out << "Outcome recognize(const char16_t* input, size_t size)\n{\n"
+           "    std::vector<int32_t> stack;\n"
+           "    stack.reserve(64);\n"
+           "    stack.push_back(" << automaton.startStackSymbol() << ");\n"
+           "    int32_t state = " << automaton.startState() << ";\n"
+           "    size_t position = 0;\n\n"
+           "    for (;;) {\n"
+           "        const bool reading = position < size;\n"
+           "        if (stack.empty()) {\n"
+           "            if (reading) return Outcome::InputLeft;\n"
+           "            return isFinal(state) ? Outcome::Accepted : Outcome::NotFinalState;\n"
+           "        }\n"
+           "        const int32_t top = stack.back();\n"
+           "        if (!reading && lambdaDiverges(state, top)) return Outcome::Diverges;\n"
+           "        const int32_t symbol = reading ? inputSymbol(input[position]) : Lambda;\n\n"
+           "        switch (state) {\n";
+
+    // Без единого правила метка applied не нужна, а неиспользуемая метка даёт предупреждение при -Wall.
+    bool applies = false;
+    for (int32_t state = 0; state < knownStates; ++state) {
+        std::ostringstream tops;
+        for (int32_t top = 0; top < knownStack; ++top) {
+            std::ostringstream symbols;
+            for (int32_t symbol = 0; symbol < knownSymbols; ++symbol) {
+                const int32_t index = automaton.transition(state, symbol, top);
+                if (index == Automaton::NoTransition) {
+                    continue;
+                }
+                const Automaton::Rule& rule = automaton.rule(index);
+                symbols << "                case " << symbol << ": // " << comment(automaton.symbolName(symbol))
+                        << " -> (" << comment(automaton.stateName(rule.next)) << ", "
+                        << comment(automaton.pushText(index)) << ")\n";
+                if (rule.pop) {
+                    symbols << "                    stack.pop_back();\n";
+                }
+                const int32_t* push = automaton.pushSequence(rule);
+                for (uint32_t i = 0; i < rule.pushCount; ++i) {
+                    symbols << "                    stack.push_back(" << push[i] << ");\n";
+                }
+                symbols << "                    state = " << rule.next << ";\n"
+                        << "                    goto applied;\n";
+                applies = true;
+            }
+            if (!symbols.str().empty()) {
+                tops << "            case " << top << ": // " << comment(automaton.stackSymbolName(top)) << "\n"
+                     << "                switch (symbol) {\n" << symbols.str()
+                     << "                default:\n                    break;\n                }\n                break;\n";
+            }
+        }
+        if (!tops.str().empty()) {
+            out << "        case " << state << ": // " << comment(automaton.stateName(state)) << "\n"
+                << "            switch (top) {\n" << tops.str()
+                << "            default:\n                break;\n            }\n            break;\n";
+        }
+    }
+
+    out << "        default:\n"
+           "            break;\n"
+           "        }\n"
+           "        return reject(state, symbol, top);\n";
+    if (applies) {
+        out << "\n"
+               "    applied:\n"
+               "        if (reading) ++position;\n";
+    }
+    out << "    }\n"
+           "}\n\n"
+           "}\n";
+    out << format(Main, space);
+    return out.str();
+}
@@ -0,0 +1,23 @@
+#ifndef RECOGNIZERGENERATOR_H
+#define RECOGNIZERGENERATOR_H
+
+#include "automaton.h"
+
+#include <string>
+
+// Порождает исходный текст C++17 распознавателя, специализированного под автомат:
+// состояния и символы становятся константами, переходы — вложенными switch,
+// поэтому во время работы нет ни таблиц, ни разбора конфигурации.
+//
+// Сгенерированный файл объявляет в пространстве имён space
+//     enum class Outcome { Accepted, UnknownState, ... };
+//     Outcome recognize(const char16_t* input, size_t size);
+// с теми же исходами, что и Engine::run(). При -DPDA_RECOGNIZER_MAIN в него добавляется
+// main(), печатающий исход для каждой строки stdin (используется machine-codegen --verify).
+// space должно быть идентификатором C++ (см. isIdentifier()).
+std::string generateRecognizer(const Automaton& automaton, const std::string& space);
+
+// Латинские буквы, цифры и '_', не с цифры и не ключевое слово.
+bool isIdentifier(const std::string& name);
+
+#endif // RECOGNIZERGENERATOR_H
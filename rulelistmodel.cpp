@@ -0,0 +1,128 @@
+#include "rulelistmodel.h"
+
+#include <QBrush>
+#include <QColor>
+
+#include <algorithm>
+#include <numeric>
+#include <string_view>
+#include <tuple>
+
+namespace {
+
+QString toQString(std::u16string_view text)
+{
+    return QString::fromUtf16(text.data(), text.size());
+}
+
+// Место каждого номера в порядке возрастания имён.
+template <typename Name>
+std::vector<int32_t> rankByName(int32_t count, Name name)
+{
+    std::vector<int32_t> order(size_t(count));
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int32_t a, int32_t b) { return name(a) < name(b); });
+
+    std::vector<int32_t> rank(size_t(count));
+    for (int32_t i = 0; i < count; ++i) {
+        rank[order[i]] = i;
+    }
+    return rank;
+}
+
+}
+
+RuleListModel::RuleListModel(const Automaton& automaton, QObject *parent)
+    : QAbstractListModel(parent)
+    , automaton(automaton)
+{
+    if (automaton.isEmpty()) {
+        return;
+    }
+
+    const auto states = rankByName(automaton.stateCount(), [&](int32_t id) { return automaton.stateName(id); });
+    const auto symbols = rankByName(automaton.symbolCount(), [&](int32_t id) { return automaton.symbolName(id); });
+    const auto stack = rankByName(automaton.stackSymbolCount(), [&](int32_t id) { return automaton.stackSymbolName(id); });
+    auto key = [&](int32_t rule) {
+        const Automaton::RuleKey& k = automaton.ruleKey(rule);
+        return std::make_tuple(states[k.state], symbols[k.symbol], stack[k.top]);
+    };
+
+    std::vector<int32_t> order(size_t(automaton.ruleCount()));
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int32_t a, int32_t b) { return key(a) < key(b); });
+
+    // Из правил с одинаковым ключом действует последнее, как при перезаписи в ДМПА.
+    ruleRows.assign(order.size(), -1);
+    rows.reserve(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        if (i + 1 < order.size() && key(order[i]) == key(order[i + 1])) {
+            continue;
+        }
+        ruleRows[order[i]] = int32_t(rows.size());
+        rows.push_back(order[i]);
+    }
+}
+
+int RuleListModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : int(rows.size());
+}
+
+QVariant RuleListModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= int(rows.size())) {
+        return QVariant();
+    }
+
+    const int32_t rule = rows[index.row()];
+    if (role == Qt::DisplayRole) {
+        const Automaton::RuleKey& key = automaton.ruleKey(rule);
+        QString text = QString("(%1, %2, %3) -> (%4, %5)")
+            .arg(toQString(automaton.stateName(key.state)),
+                 toQString(automaton.symbolName(key.symbol)),
+                 toQString(automaton.stackSymbolName(key.top)),
+                 toQString(automaton.stateName(automaton.rule(rule).next)),
+                 toQString(automaton.pushText(rule)));
+        if (size_t(rule) < ruleHits.size()) {
+            text += QString("    × %1").arg(ruleHits[rule]);
+        }
+        return text;
+    }
+    if (role == Qt::BackgroundRole && index.row() == highlighted) {
+        return QBrush(QColor(144, 238, 144));
+    }
+    return QVariant();
+}
+
+int RuleListModel::rowOfRule(int rule) const
+{
+    return rule >= 0 && rule < int(ruleRows.size()) ? ruleRows[rule] : -1;
+}
+
+void RuleListModel::setRuleHits(const std::vector<uint64_t>& hits)
+{
+    ruleHits = hits;
+    if (!rows.empty()) {
+        emit dataChanged(index(0), index(int(rows.size()) - 1), {Qt::DisplayRole});
+    }
+}
+
+QModelIndex RuleListModel::highlightRule(int rule)
+{
+    const int row = rowOfRule(rule);
+    if (row == highlighted) {
+        return row >= 0 ? index(row) : QModelIndex();
+    }
+
+    const int previous = highlighted;
+    highlighted = row;
+    if (previous >= 0) {
+        emit dataChanged(index(previous), index(previous), {Qt::BackgroundRole});
+    }
+    if (row < 0) {
+        return QModelIndex();
+    }
+    emit dataChanged(index(row), index(row), {Qt::BackgroundRole});
+    return index(row);
+}
@@ -0,0 +1,38 @@
+#ifndef RULELISTMODEL_H
+#define RULELISTMODEL_H
+
+#include <QAbstractListModel>
+
+#include <vector>
+
+#include "automaton.h"
+
+// Список правил автомата, строки которого формируются только при отрисовке.
+// Для каждого ключа (состояние, символ, вершина) показывается действующее правило,
+// строки упорядочены по именам ключа; номер строки правила находится за O(1).
+class RuleListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit RuleListModel(const Automaton& automaton, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    // -1, если правило перекрыто более поздним с тем же ключом.
+    int rowOfRule(int rule) const;
+    // Подсвечивает строку правила (rule = -1 снимает подсветку) и возвращает её индекс.
+    QModelIndex highlightRule(int rule);
+    // Число срабатываний по номерам правил; показывается в конце строк. Пустой вектор скрывает счётчики.
+    void setRuleHits(const std::vector<uint64_t>& hits);
+
+private:
+    Automaton automaton;
+    std::vector<int32_t> rows;
+    std::vector<int32_t> ruleRows;
+    std::vector<uint64_t> ruleHits;
+    int highlighted = -1;
+};
+
+#endif // RULELISTMODEL_H
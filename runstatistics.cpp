@@ -0,0 +1,29 @@
+#include "runstatistics.h"
+
+#include <algorithm>
+
+void RunStatistics::reset(int32_t ruleCount)
+{
+    *this = RunStatistics();
+    ruleHits.assign(size_t(std::max(ruleCount, 0)), 0);
+}
+
+void RunStatistics::merge(const RunStatistics& other)
+{
+    if (ruleHits.size() < other.ruleHits.size()) {
+        ruleHits.resize(other.ruleHits.size());
+    }
+    for (size_t i = 0; i < other.ruleHits.size(); ++i) {
+        ruleHits[i] += other.ruleHits[i];
+    }
+    for (int i = 0; i < DepthBuckets; ++i) {
+        depthHistogram[i] += other.depthHistogram[i];
+    }
+    maxDepth = std::max(maxDepth, other.maxDepth);
+    depthSum += other.depthSum;
+    inputMoves += other.inputMoves;
+    lambdaMoves += other.lambdaMoves;
+    inputSymbols += other.inputSymbols;
+    runs += other.runs;
+    accepted += other.accepted;
+}
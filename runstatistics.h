@@ -0,0 +1,56 @@
+#ifndef RUNSTATISTICS_H
+#define RUNSTATISTICS_H
+
+#include <cstdint>
+#include <vector>
+
+// Счётчики выполнения: сколько раз сработало каждое правило, глубина стека после шагов,
+// число переходов по входу и λ-переходов, время этапов. Заполняются исполнителем,
+// которому передан указатель на них (см. Engine::setStatistics()).
+struct RunStatistics
+{
+    // Корзина k гистограммы глубин содержит глубины из [2^(k-1), 2^k), корзина 0 — пустой стек.
+    static constexpr int DepthBuckets = 65;
+
+    std::vector<uint64_t> ruleHits;
+    std::vector<uint64_t> depthHistogram = std::vector<uint64_t>(DepthBuckets);
+    uint64_t maxDepth = 0;
+    uint64_t depthSum = 0;
+    uint64_t inputMoves = 0;
+    uint64_t lambdaMoves = 0;
+    uint64_t inputSymbols = 0;
+    uint64_t runs = 0;
+    uint64_t accepted = 0;
+    double loadSeconds = 0;
+    double compileSeconds = 0;
+    double runSeconds = 0;
+
+    void reset(int32_t ruleCount);
+    // Складывает счётчики; время этапов не складывается.
+    void merge(const RunStatistics& other);
+
+    void recordStep(int32_t rule, bool lambda, uint64_t depth)
+    {
+        ++ruleHits[rule];
+        ++(lambda ? lambdaMoves : inputMoves);
+        depthSum += depth;
+        maxDepth = depth > maxDepth ? depth : maxDepth;
+        ++depthHistogram[depthBucket(depth)];
+    }
+
+    uint64_t steps() const { return inputMoves + lambdaMoves; }
+    double meanDepth() const { return steps() ? double(depthSum) / double(steps()) : 0.0; }
+    double stepsPerSymbol() const { return inputSymbols ? double(steps()) / double(inputSymbols) : 0.0; }
+
+    static int depthBucket(uint64_t depth)
+    {
+        int bucket = 0;
+        while (depth) {
+            depth >>= 1;
+            ++bucket;
+        }
+        return bucket;
+    }
+};
+
+#endif // RUNSTATISTICS_H
@@ -0,0 +1,97 @@
+#include "nondeterministicsearch.h"
+
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+const int ShortRuns = 2000;
+const size_t LongLength = 200000;
+
+// Палиндромы чётной длины над {a, b}: на каждом символе автомат угадывает, началась ли вторая половина.
+Automaton palindromes()
+{
+    AutomatonSpec spec;
+    spec.states = {u"p", u"q", u"f"};
+    spec.alphabet = {u"a", u"b", u"λ"};
+    spec.inStack = {u"A", u"B", u"Z"};
+    for (const std::u16string top : {u"A", u"B", u"Z"}) {
+        spec.rules.push_back({u"p", u"a", top, u"p", u"A" + top});
+        spec.rules.push_back({u"p", u"b", top, u"p", u"B" + top});
+    }
+    spec.rules.push_back({u"p", u"a", u"A", u"q", u"ε"});
+    spec.rules.push_back({u"p", u"b", u"B", u"q", u"ε"});
+    spec.rules.push_back({u"q", u"a", u"A", u"q", u"ε"});
+    spec.rules.push_back({u"q", u"b", u"B", u"q", u"ε"});
+    spec.rules.push_back({u"q", u"λ", u"Z", u"f", u"ε"});
+    spec.start = u"p";
+    spec.startStack = u"Z";
+    spec.ends = {u"f"};
+    return Automaton::compile(spec);
+}
+
+// Наименьшее из трёх замеров времени на один короткий запуск, в микросекундах.
+double shortRunMicroseconds(NondeterministicSearch& search)
+{
+    double best = 0;
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < ShortRuns; ++i) {
+            search.run(u"abba");
+        }
+        const double elapsed = double(timer.nsecsElapsed()) / 1e3 / ShortRuns;
+        best = attempt == 0 ? elapsed : std::min(best, elapsed);
+    }
+    return best;
+}
+
+}
+
+// Проверка NondeterministicSearch: короткий запуск после длинной цепочки стоит столько же,
+// сколько на свежем объекте, и вердикты не зависят от предыдущих запусков.
+// Запускается через make check.
+int main()
+{
+    const Automaton automaton = palindromes();
+    NondeterministicSearch search(automaton);
+
+    if (search.run(u"abba") != NondeterministicSearch::Result::Accepted
+        || search.run(u"abab") != NondeterministicSearch::Result::Rejected) {
+        std::fprintf(stderr, "неверный вердикт на короткой цепочке\n");
+        return 1;
+    }
+    const double fresh = shortRunMicroseconds(search);
+
+    // Псевдослучайная половина: ложные догадки о середине обрываются через несколько символов.
+    std::u16string half;
+    uint32_t random = 1;
+    for (size_t i = 0; i < LongLength / 2; ++i) {
+        random = random * 1664525u + 1013904223u;
+        half += random >> 31 ? u'a' : u'b';
+    }
+    std::u16string text = half;
+    text.append(half.rbegin(), half.rend());
+    if (search.run(text) != NondeterministicSearch::Result::Accepted) {
+        std::fprintf(stderr, "неверный вердикт на длинной цепочке\n");
+        return 1;
+    }
+    const uint64_t configurations = search.configurations();
+
+    if (search.run(u"abab") != NondeterministicSearch::Result::Rejected) {
+        std::fprintf(stderr, "неверный вердикт после длинной цепочки\n");
+        return 1;
+    }
+    const double reused = shortRunMicroseconds(search);
+
+    std::fprintf(stderr, "короткий запуск: %.2f мкс на свежем объекте, %.2f мкс после цепочки из %zu символов "
+                         "(%llu конфигураций)\n",
+                 fresh, reused, text.size(), static_cast<unsigned long long>(configurations));
+    if (reused > fresh * 4 + 5) {
+        std::fprintf(stderr, "стоимость короткого запуска выросла после длинной цепочки\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,11 @@
+QT = core
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = npda-check
+
+include(../engine.pri)
+
+SOURCES += \
+    ../searchcheck.cpp
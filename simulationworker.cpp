@@ -0,0 +1,275 @@
+#include "simulationworker.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+
+#include <algorithm>
+
+namespace {
+
+const int SliceSteps = 65536;
+const quint64 FirstInterval = 1024;
+// Сколько ячеек стека суммарно хранят снимки; при превышении каждый второй снимок удаляется.
+const size_t MaxCheckpointCells = size_t(1) << 22;
+const qsizetype MaxShownSymbols = 256;
+const qsizetype ExportBufferSize = 1 << 20;
+
+QString toQString(std::u16string_view text)
+{
+    return QString::fromUtf16(text.data(), text.size());
+}
+
+}
+
+SimulationWorker::SimulationWorker(QObject *parent)
+    : QObject(parent)
+{
+    qRegisterMetaType<SimulationFrame>();
+    qRegisterMetaType<QVector<TraceRecord>>();
+    qRegisterMetaType<RunStatistics>();
+}
+
+SimulationWorker::~SimulationWorker() = default;
+
+void SimulationWorker::start(quint64 run, const Automaton& automaton, const QString& input, TraceLevel level)
+{
+    abortExport();
+    currentRun = run;
+    traceLevel = level;
+    pendingTrace.clear();
+    this->automaton = automaton;
+    this->input = input.toStdU16String();
+    runner = std::make_unique<Engine>(this->automaton);
+    runStatistics.reset(this->automaton.ruleCount());
+    runStatistics.runs = 1;
+    runner->setStatistics(&runStatistics);
+    cursor = std::make_unique<Engine>(this->automaton);
+    runnerPosition = 0;
+    cursorPosition = 0;
+    checkpoints.clear();
+    checkpointCells = 0;
+    interval = FirstInterval;
+    addCheckpoint();
+
+    QMetaObject::invokeMethod(this, [this, run] { runSlice(run); }, Qt::QueuedConnection);
+}
+
+void SimulationWorker::seek(quint64 run, quint64 step)
+{
+    if (run != currentRun || !runner) {
+        return;
+    }
+    step = std::min<quint64>(step, runner->steps());
+
+    if (cursor->steps() > step || step - cursor->steps() > interval) {
+        auto it = std::upper_bound(checkpoints.begin(), checkpoints.end(), step,
+                                   [](quint64 value, const Checkpoint& checkpoint) {
+                                       return value < checkpoint.snapshot.steps;
+                                   });
+        --it;
+        cursor->restore(it->snapshot);
+        cursorPosition = it->position;
+    }
+
+    Engine::Outcome outcome = Engine::Outcome::Running;
+    while (cursor->steps() < step && advance(*cursor, cursorPosition, outcome)) {
+    }
+    emit frameReady(run, frame(*cursor, cursorPosition));
+}
+
+void SimulationWorker::runSlice(quint64 run)
+{
+    if (run != currentRun) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    Engine::Outcome outcome = Engine::Outcome::Running;
+    bool running = true;
+    for (int i = 0; i < SliceSteps && running; ++i) {
+        running = advance(*runner, runnerPosition, outcome, &pendingTrace, traceLevel);
+        if (running && runner->steps() % interval == 0) {
+            addCheckpoint();
+        }
+    }
+    runStatistics.runSeconds += timer.nsecsElapsed() / 1e9;
+
+    if (!pendingTrace.isEmpty()) {
+        emit traced(run, pendingTrace);
+        pendingTrace.clear();
+    }
+    emit progress(run, runner->steps());
+    if (!running) {
+        runStatistics.inputSymbols = uint64_t(runnerPosition);
+        runStatistics.accepted = outcome == Engine::Outcome::Accepted;
+        emit statistics(run, runStatistics);
+        emit finished(run, runner->steps(), int(outcome));
+        return;
+    }
+    QMetaObject::invokeMethod(this, [this, run] { runSlice(run); }, Qt::QueuedConnection);
+}
+
+void SimulationWorker::addCheckpoint()
+{
+    checkpoints.push_back({runner->snapshot(), runnerPosition});
+    checkpointCells += runner->stack().cellCount();
+    if (checkpointCells <= MaxCheckpointCells) {
+        return;
+    }
+
+    // Прореживание: остаются снимки на шагах, кратных удвоенному интервалу.
+    interval *= 2;
+    checkpointCells = 0;
+    auto kept = std::remove_if(checkpoints.begin(), checkpoints.end(), [this](const Checkpoint& checkpoint) {
+        return checkpoint.snapshot.steps % interval != 0;
+    });
+    checkpoints.erase(kept, checkpoints.end());
+    for (const auto& checkpoint : checkpoints) {
+        checkpointCells += checkpoint.snapshot.stack.cellCount();
+    }
+}
+
+void SimulationWorker::exportTrace(quint64 run, const QString& filePath)
+{
+    if (run != currentRun || !runner) {
+        return;
+    }
+    abortExport();
+    exporting = std::make_unique<Export>(run, automaton, filePath);
+    if (!exporting->file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        exporting.reset();
+        emit exported(run, false);
+        return;
+    }
+    QMetaObject::invokeMethod(this, [this, run] { exportSlice(run); }, Qt::QueuedConnection);
+}
+
+void SimulationWorker::exportSlice(quint64 run)
+{
+    if (!exporting || exporting->run != run) {
+        return;
+    }
+
+    Export& job = *exporting;
+    QVector<TraceRecord> records;
+    bool running = true;
+    for (int i = 0; i < SliceSteps && running; ++i) {
+        running = advance(job.engine, job.position, job.outcome, &records, TraceLevel::Transitions);
+    }
+    bool ok = true;
+    for (const TraceRecord& record : records) {
+        job.buffer += toQString(describeTraceRecord(automaton, record)).toUtf8();
+        job.buffer += '\n';
+        if (job.buffer.size() >= ExportBufferSize) {
+            ok = ok && job.file.write(job.buffer) == job.buffer.size();
+            job.buffer.clear();
+        }
+    }
+    if (!running) {
+        ok = ok && job.file.write(job.buffer) == job.buffer.size();
+    }
+
+    if (!ok || !running) {
+        exporting.reset();
+        emit exported(run, ok);
+        return;
+    }
+    emit exportProgress(run, job.engine.steps());
+    QMetaObject::invokeMethod(this, [this, run] { exportSlice(run); }, Qt::QueuedConnection);
+}
+
+// Недописанный файл удаляется: движок записи ссылается на автомат, который start() заменяет.
+void SimulationWorker::abortExport()
+{
+    if (exporting) {
+        exporting->file.remove();
+        exporting.reset();
+    }
+}
+
+void SimulationWorker::setAutomaton(const Automaton& automaton)
+{
+    recognizer = automaton.isEmpty() ? nullptr : std::make_unique<IncrementalRecognizer>(automaton);
+}
+
+void SimulationWorker::evaluate(quint64 request, const QString& input)
+{
+    if (!recognizer) {
+        emit evaluated(request, int(Engine::Outcome::Running));
+        return;
+    }
+    const std::u16string_view text(reinterpret_cast<const char16_t*>(input.utf16()), size_t(input.size()));
+    emit evaluated(request, int(recognizer->evaluate(text)));
+}
+
+bool SimulationWorker::advance(Engine& engine, qsizetype& position, Engine::Outcome& outcome,
+                               QVector<TraceRecord> *trace, TraceLevel level) const
+{
+    const bool reading = position < qsizetype(input.size());
+    if (engine.stack().empty()) {
+        if (reading) {
+            outcome = Engine::Outcome::InputLeft;
+        }
+        else {
+            outcome = automaton.isFinal(engine.state()) ? Engine::Outcome::Accepted : Engine::Outcome::NotFinalState;
+        }
+        return false;
+    }
+    if (!reading && engine.lambdaDiverges()) {
+        outcome = Engine::Outcome::Diverges;
+        return false;
+    }
+
+    const int32_t state = engine.state();
+    const int32_t top = engine.stack().top();
+    const int32_t symbol = reading ? automaton.inputSymbol(input[position]) : automaton.lambda();
+    const Engine::Outcome result = engine.step(symbol);
+    if (result != Engine::Outcome::Running) {
+        outcome = result;
+        return false;
+    }
+    if (trace && ExecutionTrace::accepts(level, reading)) {
+        trace->append({engine.steps(), uint64_t(position), engine.stack().size(), state, symbol, top, engine.lastRule()});
+    }
+    if (reading) {
+        ++position;
+    }
+    return true;
+}
+
+SimulationFrame SimulationWorker::frame(const Engine& engine, qsizetype position) const
+{
+    SimulationFrame f;
+    f.step = engine.steps();
+    f.state = toQString(automaton.stateName(engine.state()));
+    f.rule = engine.lastRule();
+
+    const qsizetype left = qsizetype(input.size()) - position;
+    if (left <= 0) {
+        f.command = "λ";
+    }
+    else {
+        f.command = toQString(std::u16string_view(input).substr(position, std::min(left, MaxShownSymbols)));
+        if (left > MaxShownSymbols) {
+            f.command += "…";
+        }
+    }
+
+    f.stackEmpty = engine.stack().empty();
+    if (!f.stackEmpty) {
+        f.top = toQString(automaton.stackSymbolName(engine.stack().top()));
+    }
+    qsizetype shown = 0;
+    engine.stack().forEachRunFromTop([&](int32_t symbol, uint32_t count) {
+        const QString name = toQString(automaton.stackSymbolName(symbol));
+        for (uint32_t i = 0; i < count && shown < MaxShownSymbols; ++i, ++shown) {
+            f.stack += name;
+        }
+        return shown < MaxShownSymbols;
+    });
+    if (engine.stack().size() > uint64_t(shown)) {
+        f.stack += "…";
+    }
+    return f;
+}
@@ -0,0 +1,115 @@
+#ifndef SIMULATIONWORKER_H
+#define SIMULATIONWORKER_H
+
+#include <QFile>
+#include <QMetaType>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#include <memory>
+
+#include "engine.h"
+#include "executiontrace.h"
+#include "incrementalrecognizer.h"
+
+// Конфигурация автомата после step переходов в виде, готовом для журнала.
+struct SimulationFrame
+{
+    quint64 step = 0;
+    QString state;
+    QString command;
+    QString stack;
+    QString top;
+    bool stackEmpty = false;
+    int rule = -1;
+};
+
+Q_DECLARE_METATYPE(SimulationFrame)
+Q_DECLARE_METATYPE(TraceRecord)
+Q_DECLARE_METATYPE(RunStatistics)
+
+// Выполняет симуляцию в отдельном потоке. Прогон идёт порциями, чтобы между ними
+// обрабатывались запросы seek(); каждые interval шагов сохраняется снимок
+// конфигурации, и переход к шагу N начинается с ближайшего снимка, а не с начала.
+// Выполненные переходы отправляются в интерфейс пачками вместе с progress(),
+// счётчики прогона (RunStatistics) — перед finished().
+// Независимо от прогона evaluate() проверяет редактируемую цепочку, продолжая с общего
+// префикса с предыдущей проверкой.
+class SimulationWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SimulationWorker(QObject *parent = nullptr);
+    ~SimulationWorker();
+
+    void start(quint64 run, const Automaton& automaton, const QString& input, TraceLevel level);
+    void seek(quint64 run, quint64 step);
+    // Записывает все переходы прогона в текстовый файл, повторяя его с начала. Повтор идёт
+    // порциями, как и прогон, поэтому seek() обрабатывается и во время записи; после каждой
+    // порции приходит exportProgress().
+    void exportTrace(quint64 run, const QString& filePath);
+    void setAutomaton(const Automaton& automaton);
+    void evaluate(quint64 request, const QString& input);
+
+signals:
+    void frameReady(quint64 run, const SimulationFrame& frame);
+    void progress(quint64 run, quint64 steps);
+    void traced(quint64 run, const QVector<TraceRecord>& records);
+    void exportProgress(quint64 run, quint64 steps);
+    void exported(quint64 run, bool ok);
+    void evaluated(quint64 request, int outcome);
+    void statistics(quint64 run, const RunStatistics& statistics);
+    void finished(quint64 run, quint64 steps, int outcome);
+
+private:
+    struct Checkpoint
+    {
+        Engine::Snapshot snapshot;
+        qsizetype position;
+    };
+
+    struct Export
+    {
+        Export(quint64 run, const Automaton& automaton, const QString& filePath)
+            : run(run)
+            , file(filePath)
+            , engine(automaton)
+        {
+        }
+
+        quint64 run;
+        QFile file;
+        Engine engine;
+        qsizetype position = 0;
+        Engine::Outcome outcome = Engine::Outcome::Running;
+        QByteArray buffer;
+    };
+
+    Automaton automaton;
+    std::u16string input;
+    std::unique_ptr<Engine> runner;
+    std::unique_ptr<Engine> cursor;
+    qsizetype runnerPosition = 0;
+    qsizetype cursorPosition = 0;
+    std::vector<Checkpoint> checkpoints;
+    quint64 interval = 0;
+    size_t checkpointCells = 0;
+    quint64 currentRun = 0;
+    TraceLevel traceLevel = TraceLevel::None;
+    QVector<TraceRecord> pendingTrace;
+    RunStatistics runStatistics;
+    std::unique_ptr<IncrementalRecognizer> recognizer;
+    std::unique_ptr<Export> exporting;
+
+    void runSlice(quint64 run);
+    void exportSlice(quint64 run);
+    void abortExport();
+    void addCheckpoint();
+    bool advance(Engine& engine, qsizetype& position, Engine::Outcome& outcome,
+                 QVector<TraceRecord> *trace = nullptr, TraceLevel level = TraceLevel::None) const;
+    SimulationFrame frame(const Engine& engine, qsizetype position) const;
+};
+
+#endif // SIMULATIONWORKER_H
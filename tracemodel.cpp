@@ -0,0 +1,73 @@
+#include "tracemodel.h"
+
+namespace {
+
+const size_t TraceCapacity = size_t(1) << 18;
+
+}
+
+TraceModel::TraceModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , trace(TraceCapacity)
+{
+}
+
+void TraceModel::reset(const Automaton& automaton)
+{
+    beginResetModel();
+    this->automaton = automaton;
+    trace.clear();
+    endResetModel();
+}
+
+void TraceModel::append(const QVector<TraceRecord>& records)
+{
+    if (records.isEmpty()) {
+        return;
+    }
+    if (size_t(records.size()) >= trace.capacity()) {
+        beginResetModel();
+        for (const TraceRecord& record : records) {
+            trace.append(record);
+        }
+        endResetModel();
+        return;
+    }
+
+    const size_t total = trace.size() + size_t(records.size());
+    if (total > trace.capacity()) {
+        const size_t overflow = total - trace.capacity();
+        beginRemoveRows(QModelIndex(), 0, int(overflow) - 1);
+        trace.dropFront(overflow);
+        endRemoveRows();
+    }
+    const int first = int(trace.size());
+    beginInsertRows(QModelIndex(), first, first + int(records.size()) - 1);
+    for (const TraceRecord& record : records) {
+        trace.append(record);
+    }
+    endInsertRows();
+}
+
+int TraceModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : int(trace.size());
+}
+
+QVariant TraceModel::data(const QModelIndex& index, int role) const
+{
+    if (role != Qt::DisplayRole || !index.isValid() || size_t(index.row()) >= trace.size()) {
+        return QVariant();
+    }
+    const std::u16string text = describeTraceRecord(automaton, trace.at(size_t(index.row())));
+    return QString::fromUtf16(text.data(), qsizetype(text.size()));
+}
+
+QModelIndex TraceModel::indexOfStep(quint64 step) const
+{
+    const size_t row = trace.lowerBound(step);
+    if (row == trace.size() || trace.at(row).step != step) {
+        return QModelIndex();
+    }
+    return index(int(row));
+}
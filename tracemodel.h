@@ -0,0 +1,33 @@
+#ifndef TRACEMODEL_H
+#define TRACEMODEL_H
+
+#include <QAbstractListModel>
+#include <QVector>
+
+#include "executiontrace.h"
+
+// Трасса прогона для списка в интерфейсе. Хранит последние записи в кольцевом буфере
+// и форматирует только те строки, которые запрашивает представление.
+class TraceModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit TraceModel(QObject *parent = nullptr);
+
+    void reset(const Automaton& automaton);
+    void append(const QVector<TraceRecord>& records);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    // Строка перехода на шаг step; невалидный индекс, если шаг не попал в трассу или вытеснен.
+    QModelIndex indexOfStep(quint64 step) const;
+    quint64 dropped() const { return trace.dropped(); }
+
+private:
+    Automaton automaton;
+    ExecutionTrace trace;
+};
+
+#endif // TRACEMODEL_H
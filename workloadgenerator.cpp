@@ -0,0 +1,273 @@
+#include "workloadgenerator.h"
+
+#include <algorithm>
+
+namespace {
+
+std::u16string symbolName(int32_t index)
+{
+    static const char16_t Simple[] = u"0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+    if (index < 62) {
+        return std::u16string(1, Simple[index]);
+    }
+    return std::u16string(1, char16_t(0x4E00 + index - 62));
+}
+
+std::u16string stateName(int32_t index)
+{
+    std::u16string name = u"q";
+    for (char c : std::to_string(index)) {
+        name += char16_t(c);
+    }
+    return name;
+}
+
+}
+
+WorkloadGenerator::WorkloadGenerator(const WorkloadOptions& options)
+    : options(options)
+    , random(options.seed)
+{
+    this->options.states = std::max(this->options.states, 1);
+    this->options.symbols = std::clamp(this->options.symbols, 1, MaxSymbols);
+    this->options.stackSymbols = std::clamp(this->options.stackSymbols, 1, MaxSymbols);
+    this->options.rules = std::max(this->options.rules, 1);
+    this->options.lambdaDensity = std::clamp(this->options.lambdaDensity, 0.0, 1.0);
+
+    switch (this->options.kind) {
+    case WorkloadOptions::Kind::Random:
+        generateRandom();
+        break;
+    case WorkloadOptions::Kind::Palindrome:
+        generatePalindrome();
+        break;
+    case WorkloadOptions::Kind::Lambda:
+        generateLambda();
+        break;
+    }
+}
+
+// splitmix64: короткий и одинаковый везде, в отличие от распределений std::.
+uint64_t WorkloadGenerator::next()
+{
+    uint64_t z = (random += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+uint32_t WorkloadGenerator::below(uint32_t bound)
+{
+    return uint32_t(((next() >> 32) * uint64_t(bound)) >> 32);
+}
+
+double WorkloadGenerator::unit()
+{
+    return double(next() >> 11) / double(uint64_t(1) << 53);
+}
+
+void WorkloadGenerator::generateRandom()
+{
+    const int32_t states = options.states;
+    const int32_t symbols = options.symbols;
+    stackSymbolCount = options.stackSymbols;
+
+    // Ключи (состояние, вершина, символ), где символ symbols означает λ.
+    const uint64_t keys = uint64_t(states) * uint64_t(stackSymbolCount) * uint64_t(symbols + 1);
+    const uint64_t wanted = std::min<uint64_t>(uint64_t(options.rules), keys);
+    std::vector<bool> used(keys);
+
+    auto addRule = [&](int32_t state, int32_t symbol, int32_t top) {
+        Rule rule{state, symbol, top, int32_t(below(uint32_t(states))), Operation::Pop, {}};
+        switch (below(3)) {
+        case 0:
+            break;
+        case 1:
+            rule.operation = Operation::Replace;
+            rule.pushed.push_back(int32_t(below(uint32_t(stackSymbolCount))));
+            break;
+        default:
+            rule.operation = Operation::Push;
+            for (uint32_t i = 0, count = 1 + below(2); i < count; ++i) {
+                rule.pushed.push_back(int32_t(below(uint32_t(stackSymbolCount))));
+            }
+            break;
+        }
+        used[(uint64_t(state) * uint64_t(stackSymbolCount) + uint64_t(top)) * uint64_t(symbols + 1)
+             + uint64_t(symbol < 0 ? symbols : symbol)] = true;
+        rules.push_back(std::move(rule));
+    };
+
+    // Из начальной конфигурации всегда есть ход, иначе все цепочки были бы пустыми.
+    addRule(0, 0, 0);
+    rules.back().operation = Operation::Push;
+    rules.back().pushed = {int32_t(below(uint32_t(stackSymbolCount)))};
+
+    // Выборка с отказами; при почти полной таблице число попыток ограничено.
+    for (uint64_t attempts = 0; rules.size() < wanted && attempts < wanted * 16 + 1024; ++attempts) {
+        const int32_t state = int32_t(below(uint32_t(states)));
+        const int32_t top = int32_t(below(uint32_t(stackSymbolCount)));
+        const int32_t symbol = unit() < options.lambdaDensity ? -1 : int32_t(below(uint32_t(symbols)));
+        const uint64_t key = (uint64_t(state) * uint64_t(stackSymbolCount) + uint64_t(top)) * uint64_t(symbols + 1)
+                             + uint64_t(symbol < 0 ? symbols : symbol);
+        if (!used[key]) {
+            addRule(state, symbol, top);
+        }
+    }
+
+    std::vector<bool> finals(static_cast<size_t>(states));
+    for (int32_t state = 0; state < states; ++state) {
+        finals[size_t(state)] = below(2) == 0;
+    }
+    buildSpec(finals);
+}
+
+void WorkloadGenerator::generatePalindrome()
+{
+    // Последний входной символ — разделитель, для остальных есть одноимённый символ стека.
+    options.states = 3;
+    options.symbols = std::max(options.symbols, 2);
+    const int32_t letters = options.symbols - 1;
+    const int32_t marker = letters;
+    stackSymbolCount = letters + 1;
+
+    for (int32_t top = 0; top < stackSymbolCount; ++top) {
+        for (int32_t letter = 0; letter < letters; ++letter) {
+            rules.push_back({0, letter, top, 0, Operation::Push, {letter + 1}});
+        }
+        rules.push_back({0, marker, top, 1, Operation::Replace, {top}});
+    }
+    for (int32_t letter = 0; letter < letters; ++letter) {
+        rules.push_back({1, letter, letter + 1, 1, Operation::Pop, {}});
+    }
+    rules.push_back({1, -1, 0, 2, Operation::Pop, {}});
+    buildSpec({false, false, true});
+}
+
+void WorkloadGenerator::generateLambda()
+{
+    const int32_t chain = options.states;
+    const int32_t symbols = options.symbols;
+    stackSymbolCount = std::max(options.stackSymbols, 2);
+
+    for (int32_t top = 0; top < stackSymbolCount; ++top) {
+        for (int32_t symbol = 0; symbol < symbols; ++symbol) {
+            rules.push_back({0, symbol, top, 0, Operation::Push, {1 + symbol % (stackSymbolCount - 1)}});
+        }
+    }
+    for (int32_t top = 1; top < stackSymbolCount; ++top) {
+        for (int32_t state = 0; state + 1 < chain; ++state) {
+            rules.push_back({state, -1, top, state + 1, Operation::Replace, {top}});
+        }
+        rules.push_back({chain - 1, -1, top, 0, Operation::Pop, {}});
+    }
+    rules.push_back({0, -1, 0, 0, Operation::Pop, {}});
+
+    std::vector<bool> finals(static_cast<size_t>(chain));
+    finals[0] = true;
+    buildSpec(finals);
+}
+
+void WorkloadGenerator::buildSpec(const std::vector<bool>& finals)
+{
+    AutomatonSpec& spec = automatonSpec;
+    for (int32_t state = 0; state < int32_t(finals.size()); ++state) {
+        spec.states.push_back(stateName(state));
+        if (finals[size_t(state)]) {
+            spec.ends.push_back(stateName(state));
+        }
+    }
+    for (int32_t symbol = 0; symbol < options.symbols; ++symbol) {
+        spec.alphabet.push_back(symbolName(symbol));
+    }
+    spec.alphabet.push_back(u"λ");
+    for (int32_t symbol = 0; symbol < stackSymbolCount; ++symbol) {
+        spec.inStack.push_back(symbolName(symbol));
+    }
+    spec.start = stateName(0);
+    spec.startStack = symbolName(0);
+
+    const size_t pairs = finals.size() * size_t(stackSymbolCount);
+    pairStart.assign(pairs + 1, 0);
+    spec.rules.reserve(rules.size());
+    for (const Rule& rule : rules) {
+        // Однобуквенная запись заменяет вершину; в длинной последний символ — сама вершина, она остаётся.
+        std::u16string push;
+        switch (rule.operation) {
+        case Operation::Pop:
+            push = u"ε";
+            break;
+        case Operation::Replace:
+            push = symbolName(rule.pushed.front());
+            break;
+        case Operation::Push:
+            for (int32_t symbol : rule.pushed) {
+                push += symbolName(symbol);
+            }
+            push += symbolName(rule.top);
+            break;
+        }
+        spec.rules.push_back({stateName(rule.state), rule.symbol < 0 ? u"λ" : symbolName(rule.symbol),
+                              symbolName(rule.top), stateName(rule.next), push});
+        if (rule.symbol < 0) {
+            ++lambdaRuleCount;
+        }
+        else {
+            ++pairStart[size_t(rule.state) * size_t(stackSymbolCount) + size_t(rule.top) + 1];
+        }
+    }
+
+    for (size_t pair = 0; pair < pairs; ++pair) {
+        pairStart[pair + 1] += pairStart[pair];
+    }
+    inputRules.resize(pairStart.back());
+    std::vector<uint32_t> filled(pairStart.begin(), pairStart.end() - 1);
+    for (int32_t index = 0; index < int32_t(rules.size()); ++index) {
+        const Rule& rule = rules[size_t(index)];
+        if (rule.symbol >= 0) {
+            inputRules[filled[size_t(rule.state) * size_t(stackSymbolCount) + size_t(rule.top)]++] = index;
+        }
+    }
+}
+
+std::u16string WorkloadGenerator::chain(size_t length)
+{
+    std::u16string text;
+    if (options.kind == WorkloadOptions::Kind::Palindrome) {
+        const size_t half = length > 0 ? (length - 1) / 2 : 0;
+        std::u16string left;
+        for (size_t i = 0; i < half; ++i) {
+            left += symbolName(int32_t(below(uint32_t(options.symbols - 1))));
+        }
+        text = left + symbolName(options.symbols - 1);
+        text.append(left.rbegin(), left.rend());
+        return text;
+    }
+
+    int32_t state = 0;
+    std::vector<int32_t> stack{0};
+    text.reserve(length);
+    while (text.size() < length && !stack.empty()) {
+        const size_t pair = size_t(state) * size_t(stackSymbolCount) + size_t(stack.back());
+        const uint32_t first = pairStart[pair];
+        const uint32_t count = pairStart[pair + 1] - first;
+        if (count == 0) {
+            break;
+        }
+        const Rule& rule = rules[size_t(inputRules[first + below(count)])];
+        text += symbolName(rule.symbol);
+        switch (rule.operation) {
+        case Operation::Pop:
+            stack.pop_back();
+            break;
+        case Operation::Replace:
+            stack.back() = rule.pushed.front();
+            break;
+        case Operation::Push:
+            stack.insert(stack.end(), rule.pushed.rbegin(), rule.pushed.rend());
+            break;
+        }
+        state = rule.next;
+    }
+    return text;
+}
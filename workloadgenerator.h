@@ -0,0 +1,84 @@
+#ifndef WORKLOADGENERATOR_H
+#define WORKLOADGENERATOR_H
+
+#include "automaton.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct WorkloadOptions
+{
+    enum class Kind {
+        // Случайная таблица заданного размера; λ-правила занимают долю lambdaDensity пар (состояние, вершина).
+        Random,
+        // w c reverse(w): стек растёт до половины длины цепочки и состоит из коротких серий.
+        Palindrome,
+        // Каждый символ кладёт элемент в стек, а после конца входа каждый элемент снимается
+        // цепочкой из states λ-переходов.
+        Lambda
+    };
+
+    Kind kind = Kind::Random;
+    int32_t states = 64;
+    int32_t symbols = 16;
+    int32_t stackSymbols = 8;
+    int32_t rules = 4096;
+    double lambdaDensity = 0.1;
+    uint64_t seed = 1;
+};
+
+// Порождает ДМПА и подходящие для него цепочки. Генератор псевдослучайных чисел свой,
+// поэтому при одном seed автомат и цепочки одинаковы на всех платформах.
+// Имена символов — одиночные символы: сначала цифры и латиница, затем иероглифы CJK.
+class WorkloadGenerator
+{
+public:
+    static constexpr int32_t MaxSymbols = 62 + 0x5200;
+
+    explicit WorkloadGenerator(const WorkloadOptions& options);
+
+    const AutomatonSpec& spec() const { return automatonSpec; }
+    int32_t lambdaRules() const { return lambdaRuleCount; }
+
+    // Цепочка не длиннее length: случайный проход по правилам автомата из начальной конфигурации,
+    // обрывающийся, когда для текущей пары (состояние, вершина) нет правил по входу.
+    std::u16string chain(size_t length);
+
+private:
+    enum class Operation {
+        Pop,
+        Replace,
+        Push
+    };
+
+    struct Rule
+    {
+        int32_t state;
+        int32_t symbol;
+        int32_t top;
+        int32_t next;
+        Operation operation;
+        std::vector<int32_t> pushed;
+    };
+
+    WorkloadOptions options;
+    uint64_t random;
+    int32_t stackSymbolCount = 0;
+    std::vector<Rule> rules;
+    // Правила по входу для каждой пары (состояние, вершина): inputRules[pairStart[p] .. pairStart[p + 1]).
+    std::vector<uint32_t> pairStart;
+    std::vector<int32_t> inputRules;
+    AutomatonSpec automatonSpec;
+    int32_t lambdaRuleCount = 0;
+
+    uint64_t next();
+    uint32_t below(uint32_t bound);
+    double unit();
+    void generateRandom();
+    void generatePalindrome();
+    void generateLambda();
+    void buildSpec(const std::vector<bool>& finals);
+};
+
+#endif // WORKLOADGENERATOR_H
@@ -0,0 +1,52 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пул потоков с собственной очередью у каждого потока.
+// Поток берёт задачи с конца своей очереди, а опустев, крадёт с начала чужих.
+class WorkStealingPool
+{
+public:
+    explicit WorkStealingPool(unsigned threadCount = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Число очередей задаётся до запуска потоков, поэтому его можно читать из любого потока.
+    unsigned size() const { return unsigned(queues.size()); }
+
+    void submit(std::function<void()> task);
+    // Ждёт завершения всех отправленных задач, включая порождённые ими.
+    void wait();
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::atomic<size_t> queued{0};
+    std::atomic<size_t> pending{0};
+    std::atomic<unsigned> nextQueue{0};
+    bool stopping = false;
+
+    bool take(unsigned index, std::function<void()>& task);
+    void work(unsigned index);
+};
+
+#endif // WORKSTEALINGPOOL_H